@@ -0,0 +1,69 @@
+/* 
+ * File:     flash.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include "flash.h"
+#include <xc.h>
+
+// NVMCON operations, with WREN set
+#define NVM_PAGE_ERASE  0x4003
+#define NVM_DOUBLE_WORD 0x4001
+
+// Table page of the write latches
+#define NVM_LATCH_PAGE  0xFA
+
+// The upper byte of an instruction is not used, and left erased
+#define FLASH_UNUSED    0xFF
+
+/**
+ * Runs the operation set up in NVMCON and NVMADR, and waits for it
+ * @param address The program memory address of the operation
+ * @return 1 if it succeeded, 0 otherwise
+ */
+static uint8_t FLASH_execute( const uint32_t address ) {
+  
+  NVMADRU = (uint16_t)( address >> 16 );
+  NVMADR = (uint16_t)address;
+  
+  // unlocks, and sets WR, with interrupts held off for the sequence
+  __builtin_write_NVM();
+  while( NVMCONbits.WR ) {}
+  
+  NVMCONbits.WREN = 0;
+  return !NVMCONbits.WRERR;
+}
+
+uint8_t FLASH_erase_page( const uint32_t address ) {
+  NVMCON = NVM_PAGE_ERASE;
+  return FLASH_execute( address );
+}
+
+uint8_t FLASH_write_double( const uint32_t address, const uint16_t first, const uint16_t second ) {
+  
+  uint16_t page = TBLPAG;
+  
+  NVMCON = NVM_DOUBLE_WORD;
+  
+  TBLPAG = NVM_LATCH_PAGE;
+  __builtin_tblwtl( 0, first );
+  __builtin_tblwth( 0, FLASH_UNUSED );
+  __builtin_tblwtl( 2, second );
+  __builtin_tblwth( 2, FLASH_UNUSED );
+  TBLPAG = page;
+  
+  return FLASH_execute( address );
+}
+
+uint16_t FLASH_read_word( const uint32_t address ) {
+  
+  uint16_t page = TBLPAG;
+  uint16_t word;
+  
+  TBLPAG = (uint16_t)( address >> 16 );
+  word = __builtin_tblrdl( (uint16_t)address );
+  TBLPAG = page;
+  
+  return word;
+}
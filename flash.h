@@ -0,0 +1,66 @@
+/* 
+ * File:     flash.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef FLASH_H
+#define	FLASH_H
+
+#include <stdint.h>
+
+/*
+ * Program memory can be erased and written at run time, to keep data
+ * across power cycles. It is made of 24-bit instructions, two addresses
+ * apart, erased a page of 1024 instructions at a time and written two
+ * instructions at a time. Only the low 16 bits of each instruction are
+ * used here, so a page holds 2048 bytes of data, one per address.
+ * 
+ * The CPU stalls while the flash is erased or written.
+ * 
+ * Reference: PIC24FJ128GA204 Family Data Sheet
+ *            5.0 "Flash Program Memory"
+ */
+
+// Addresses per erase page, which is also the bytes of data it holds
+#define FLASH_PAGE_ADDRESSES 2048UL
+
+/**
+ * Erases a page of program memory
+ * 
+ * Precondition:
+ *   address is the first address of a page, which holds no code.
+ * 
+ * Postcondition:
+ *   Every word of the page reads 0xFFFF.
+ * 
+ * @param address The program memory address of the page
+ * @return 1 if the page was erased, 0 otherwise
+ */
+uint8_t FLASH_erase_page( const uint32_t address );
+
+/**
+ * Writes two consecutive words of program memory
+ * 
+ * Precondition:
+ *   address is a multiple of 4, and both words are erased.
+ * 
+ * Postcondition:
+ *   The words hold first and second.
+ * 
+ * @param address The program memory address of the first word
+ * @param first The value of the first word
+ * @param second The value of the second word
+ * @return 1 if the words were written, 0 otherwise
+ */
+uint8_t FLASH_write_double( const uint32_t address, const uint16_t first, const uint16_t second );
+
+/**
+ * Reads a word of program memory
+ * 
+ * @param address The program memory address, which must be even
+ * @return The low 16 bits of the instruction at address
+ */
+uint16_t FLASH_read_word( const uint32_t address );
+
+#endif	/* FLASH_H */
@@ -1,16 +1,23 @@
 /* 
  * File:     gps.c
  * Author:   Christopher Madrigal
- * Modified: 20 February 2020
+ * Modified: 17 October 2026
  */
 
 #include "gps.h"
+#include "nmea.h"
+#include "ubx.h"
 #include "i2c.h"
-#include <stdio.h>
+#include "flash.h"
+#include "mcc_generated_files/ext_int.h"
+#include "mcc_generated_files/pin_manager.h"
 
 // I2C address of the GPS device
 #define GPS_ADDRESS  0x42
 
+// The DDC supports fast mode, which the bus runs as close to as it can
+#define GPS_I2C_SPEED I2C2_SPEED_FAST
+
 // The GPS keeps a count of available chars to read. It is a 16-bit wide value,
 // whose high and low bytes are in the given registers.
 #define REG_NUM_HIGH 0xFD
@@ -26,189 +33,1234 @@
  *            11.5 "DDC Port", pg. 34
  */
 
-/* Configuration Command
+/* Configuration
+ * 
+ * The GPS is configured with UBX-CFG messages, each of which the GPS
+ * answers with UBX-ACK-ACK if it was accepted, or UBX-ACK-NAK if not.
+ * UBX output is therefore kept enabled on the DDC port in both modes.
+ * 
+ * CFG-PRT keeps the DDC port at the same slave address and accepts both
+ * UBX and NMEA as input. CFG-MSG sets how often a message is output on
+ * the port it was received on, in navigation epochs (0 disables it).
+ * 
+ * CFG-NAV5 sets the dynamic platform model for flight (see below), and is
+ * read back to make sure the GPS took it.
+ * 
+ * NAV-EOE is output in both modes, to mark the end of every epoch.
+ * 
+ * CFG-PRT also has the GPS raise its TX-ready pin while data is pending on
+ * the port, which interrupts the PIC on INT1 (see Background ingestion).
+ * 
+ * Once everything is accepted, CFG-CFG saves it to battery-backed RAM and
+ * flash, so that it survives a reset of the GPS. On the next gps_init the
+ * configuration is read back, and nothing is sent if it already matches.
+ * 
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-CFG-PRT (0x06 0x00)", "Port Configuration for DDC Port"
+ *            "UBX-CFG-MSG (0x06 0x01)", "Set Message Rate"
+ *            "UBX-CFG-CFG (0x06 0x09)", "Clear, Save and Load configurations"
+ *            "Receiver Configuration"
+ */
+
+// Protocol masks of CFG-PRT
+#define PROTO_UBX  0x01
+#define PROTO_NMEA 0x02
+
+/* TX-ready of CFG-PRT
+ * The GPS PIO wired to GPS_TXREADY (RB7) is driven high once at least
+ * GPS_TXREADY_THRES * 8 bytes are pending, and low once they are read.
+ * The threshold is kept low, so the end of an epoch is never left waiting
+ * for more output; an epoch is read in as many passes as it rises.
+ */
+#define GPS_TXREADY_PIO   6
+#define GPS_TXREADY_THRES 1
+#define TXREADY_EN        0x0001
+#define TXREADY_FIELD     ( TXREADY_EN | ( GPS_TXREADY_PIO << 2 ) | ( GPS_TXREADY_THRES << 7 ) )
+
+/* NMEA messages and their rate, in GPS_MODE_NMEA
+ * Only RMC and GGA are output
+ */
+const uint8_t NMEA_RATES[][2] = {
+  { 0x04, 1 }, // RMC
+  { 0x00, 1 }, // GGA
+  { 0x09, 0 }, // GBS
+  { 0x01, 0 }, // GLL
+  { 0x0D, 0 }, // GNS
+  { 0x06, 0 }, // GRS
+  { 0x02, 0 }, // GSA
+  { 0x07, 0 }, // GST
+  { 0x03, 0 }, // GSV
+  { 0x41, 0 }, // TXT
+  { 0x0F, 0 }, // VLW
+  { 0x05, 0 }, // VTG
+  { 0x08, 0 }  // ZDA
+};
+
+// Output by default, so its rate tells a configured GPS from a fresh one
+#define NMEA_GSV 0x03
+
+/* Constellations of CFG-GNSS
+ * 
+ * Each block of CFG-GNSS sets the tracking channels of one constellation,
+ * and enables it with its first signal. Every block is always sent, so
+ * the GPS is left with nothing from an earlier selection.
+ * 
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-CFG-GNSS (0x06 0x3E)", "GNSS system configuration"
+ *            "GNSS Configuration"
+ */
+#define GNSS_ID_GPS     0
+#define GNSS_ID_SBAS    1
+#define GNSS_ID_GALILEO 2
+#define GNSS_ID_BEIDOU  3
+#define GNSS_ID_IMES    4
+#define GNSS_ID_QZSS    5
+#define GNSS_ID_GLONASS 6
+
+#define GNSS_HEADER     4
+#define GNSS_BLOCK      8
+#define GNSS_ENABLE     0x01
+#define GNSS_SIG_L1     0x01 // first signal of every constellation, in flags bits 16-23
+
+/* gnssId, resTrkCh, maxTrkCh, and the GPS_GNSS_* flag that enables it
+ * (SBAS and QZSS follow GPS, IMES is never used)
+ */
+const uint8_t GNSS_BLOCKS[][4] = {
+  { GNSS_ID_GPS,     8, 16, GPS_GNSS_GPS },
+  { GNSS_ID_SBAS,    1,  3, GPS_GNSS_GPS },
+  { GNSS_ID_GALILEO, 4,  8, GPS_GNSS_GALILEO },
+  { GNSS_ID_BEIDOU,  8, 16, GPS_GNSS_BEIDOU },
+  { GNSS_ID_IMES,    0,  8, 0 },
+  { GNSS_ID_QZSS,    0,  3, GPS_GNSS_GPS },
+  { GNSS_ID_GLONASS, 8, 14, GPS_GNSS_GLONASS }
+};
+
+#define GNSS_BLOCK_COUNT ( sizeof( GNSS_BLOCKS ) / sizeof( GNSS_BLOCKS[0] ) )
+
+/* UBX messages and their rate, in GPS_MODE_UBX
+ * NAV-PVT is output every epoch, and NMEA is not output at all
+ */
+const uint8_t CFG_MSG_NAV_PVT[] = { UBX_CLASS_NAV, UBX_NAV_PVT, 1 };
+
+/* NAV-EOE marks the end of the output of every epoch, in both modes
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-NAV-EOE (0x01 0x61)", "End Of Epoch"
+ */
+const uint8_t CFG_MSG_NAV_EOE[] = { UBX_CLASS_NAV, UBX_NAV_EOE, 1 };
+
+/* Dynamic platform model of CFG-NAV5
+ * 
+ * The default portable model gives up on fixes above 12 km or 310 m/s.
+ * Airborne <4g allows the most the receiver ever does, 50 km and 500 m/s,
+ * and expects the dynamics of a vehicle in flight.
  * 
- * BAUD = 9600
- * Communication Port = 0 (I2C)
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-CFG-NAV5 (0x06 0x24)", "Navigation Engine Settings"
+ *            "Platform settings"
+ */
+#define NAV5_LENGTH             36
+#define NAV5_MASK_DYN           0x0001
+#define NAV5_DYN_AIRBORNE_4G    8
+
+#define GPS_DYN_MODEL NAV5_DYN_AIRBORNE_4G
+
+/* Save the port, message, navigation and receiver manager settings to
+ * battery-backed RAM and flash
+ */
+const uint8_t CFG_CFG_SAVE[] = {
+  0x00, 0x00, 0x00, 0x00,       // clearMask: none
+  0x1B, 0x00, 0x00, 0x00,       // saveMask: ioPort | msgConf | navConf | rxmConf
+  0x00, 0x00, 0x00, 0x00,       // loadMask: none
+  0x03                          // deviceMask: devBBR | devFlash
+};
+
+/* Power Management
  * 
- * Protocol | Threshold 9-bit  | Pin 5-bit   | Polarity  1-bit | Enable 1-bit
- *
- * Input    | 000000000 (none) | 00000 (DDC) | 1  (Active Low) | 1 (Enabled)
- * Output   | 000000000 (none) | 00000 (DCC) | 1  (Active Low) | 1 (Enabled)
+ * By default the GPS tracks continuously. CFG-PM2 can instead make it
+ * compute a fix once per update period and save power in between, either
+ * by cyclic tracking (for short periods) or by switching off entirely and
+ * reacquiring (ON/OFF, for long periods). CFG-RXM then switches between
+ * continuous and power save mode.
  * 
- * These fields are provided in hex.
+ * While power save is on, the driver expects a fix once per period, so
+ * once NAV-EOE ends an epoch it does not read the DDC port again until
+ * shortly before the next one is due. gps_schedule gives the driver the
+ * time to decide this.
  * 
  * Reference: u-blox M8 Receiver Description
+ *            "Power Management"
+ *            "UBX-CFG-PM2 (0x06 0x3B)", "Extended Power Management configuration"
+ *            "UBX-CFG-RXM (0x06 0x11)", "RXM configuration"
+ */
+
+// Longest update period that uses cyclic tracking rather than ON/OFF
+#define PM2_CYCLIC_MAX_PERIOD 10000UL
+
+// Flags of CFG-PM2, mode being bits 17-18
+#define PM2_UPDATE_RTC   0x00000800UL
+#define PM2_UPDATE_EPH   0x00001000UL
+#define PM2_MODE_ONOFF   0x00000000UL
+#define PM2_MODE_CYCLIC  0x00020000UL
+
+// How long before a fix is due the DDC port is polled again, in ms, and
+// at most what part of the period that may be
+#define GPS_WAKE_MARGIN  200
+#define GPS_WAKE_DIVISOR 5
+
+/* Navigation rate
+ * 
+ * CFG-RATE sets the time between measurements, and so between epochs.
+ * The driver follows it: the port is polled again shortly before each
+ * epoch, so a slow rate costs proportionally less I2C and CPU time. The
+ * ring holds more than an epoch of output at any rate, so it needs no
+ * resizing.
  * 
- *            32.3.1.1 "Set Protocols and Baudrate", pg. 129
- *            33.20.23.5 "Port Configuration for DDC Port", pg. 209
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-CFG-RATE (0x06 0x08)", "Navigation/Measurement Rate Settings"
  */
- 
-char CONF_PROTOCOL_BAUD[] = "$PUBX,41,0,0003,0002,9600,0*14\r\n";
+#define GPS_EPOCH_PERIOD 1000UL
+#define RATE_TIME_GPS    0x01
+
+static uint32_t epochPeriod = GPS_EPOCH_PERIOD;
+
+// Duty cycle of the GPS, 0 when tracking continuously
+static uint32_t updatePeriod = 0;
+static uint8_t  gnssTracked = 0;
+static uint8_t  scheduled = 0;
+static uint32_t scheduleNow = 0;
+static uint32_t nextFixDue = 0;
 
-/* Commands that disable output from all but the GPRMC/GPGGA networks
- * Notice "1" in the enabled networks, and "0" in the disabled ones
+/* Aiding
+ * 
+ * Without help, the GPS needs ephemerides it can only decode from the sky,
+ * so a cold start takes long. Its navigation database, ephemerides and
+ * almanac included, can be dumped by polling MGA-DBD, as a run of MGA-DBD
+ * frames. They are kept verbatim in program memory, and sent back at
+ * startup, after MGA-INI-TIME-UTC if the time is known, for a warm or hot
+ * start instead.
+ * 
+ * A store starts with a double word of GPS_AID_MAGIC and the length of
+ * the frames that follow it, then a double word of its sequence number.
+ * The first is written last, so a store that was not completed is never
+ * used. There are two stores, and a dump goes into the older one, with
+ * the next sequence number; the newest complete store is the one sent
+ * back. A dump that fails or times out leaves the last good one in place.
  * 
  * Reference: u-blox M8 Receiver Description
- *            32.3.3.1 "Set NMEA message outout rate", pg. 131
- */
-char CONF_ENABLE_GPRMC[] = "$PUBX,40,RMC,1,0,0,0,0,0*46\r\n";
-char CONF_ENABLE_GPGGA[] = "$PUBX,40,GGA,1,0,0,0,0,0*5B\r\n";
-
-char CONF_DISABLE_GPGBS[] = "$PUBX,40,GBS,0,0,0,0,0,0*4D\r\n";
-char CONF_DISABLE_GPGLL[] = "$PUBX,40,GLL,0,0,0,0,0,0*5C\r\n";
-char CONF_DISABLE_GPGNS[] = "$PUBX,40,GNS,0,0,0,0,0,0*41\r\n";
-char CONF_DISABLE_GPGRS[] = "$PUBX,40,GRS,0,0,0,0,0,0*5D\r\n";
-char CONF_DISABLE_GPGSA[] = "$PUBX,40,GSA,0,0,0,0,0,0*4E\r\n";
-char CONF_DISABLE_GPGST[] = "$PUBX,40,GST,0,0,0,0,0,0*5B\r\n";
-char CONF_DISABLE_GPGSV[] = "$PUBX,40,GSV,0,0,0,0,0,0*59\r\n";
-char CONF_DISABLE_GPTXT[] = "$PUBX,40,TXT,0,0,0,0,0,0*43\r\n";
-char CONF_DISABLE_GPVLW[] = "$PUBX,40,VLW,0,0,0,0,0,0*56\r\n";
-char CONF_DISABLE_GPVTG[] = "$PUBX,40,VTG,0,0,0,0,0,0*5E\r\n";
-char CONF_DISABLE_GPZDA[] = "$PUBX,40,ZDA,0,0,0,0,0,0*44\r\n";
-
-void gps_init( void ) {
-  I2C_block_write( GPS_ADDRESS, CONF_PROTOCOL_BAUD, sizeof( CONF_PROTOCOL_BAUD ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_ENABLE_GPRMC, sizeof( CONF_ENABLE_GPRMC ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_ENABLE_GPGGA, sizeof( CONF_ENABLE_GPGGA ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGBS, sizeof( CONF_DISABLE_GPGBS ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGLL, sizeof( CONF_DISABLE_GPGLL ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGNS, sizeof( CONF_DISABLE_GPGNS ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGRS, sizeof( CONF_DISABLE_GPGRS ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGSA, sizeof( CONF_DISABLE_GPGSA ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGST, sizeof( CONF_DISABLE_GPGST ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPGSV, sizeof( CONF_DISABLE_GPGSV ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPTXT, sizeof( CONF_DISABLE_GPTXT ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPVLW, sizeof( CONF_DISABLE_GPVLW ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPVTG, sizeof( CONF_DISABLE_GPVTG ) - 1 );
-  I2C_block_write( GPS_ADDRESS, CONF_DISABLE_GPZDA, sizeof( CONF_DISABLE_GPZDA ) - 1 );
+ *            "Multiple GNSS Assistance (MGA)"
+ *            "Preserving MGA and operational data during power-off"
+ *            "UBX-MGA-DBD (0x13 0x80)", "UBX-MGA-INI-TIME_UTC (0x13 0x40)"
+ */
+#define GPS_AID_STORES   2
+#define GPS_AID_PAGES    4
+#define GPS_AID_MAGIC    0xA1D0
+#define GPS_AID_HEADER   8
+#define GPS_AID_CAPACITY ( GPS_AID_PAGES * FLASH_PAGE_ADDRESSES - GPS_AID_HEADER )
+
+// Type of the MGA-INI message, and the accuracy claimed for its time, s
+#define MGA_INI_TIME_UTC 0x10
+#define GPS_AID_TIME_ACC 10
+
+// Pages of program memory set aside for the stores, one after the other
+static const uint16_t __attribute__(( space( prog ), aligned( FLASH_PAGE_ADDRESSES ) ))
+  aidStore[GPS_AID_STORES * GPS_AID_PAGES * FLASH_PAGE_ADDRESSES / 2];
+
+// Bytes are written four at a time
+static uint16_t aidLength;
+static uint8_t  aidPending[4];
+static uint8_t  aidFill;
+
+/* Background ingestion
+ * 
+ * Bytes are moved from the GPS into a ring buffer by a chain of I2C
+ * transactions, each one queued from the completion callback of the one
+ * before, so they run entirely from the I2C2 interrupt:
+ * 
+ *   COUNT: set the address pointer to REG_NUM_HIGH, then read the 16-bit
+ *          count of bytes available after a repeated start
+ *   DATA:  read the stream into the ring, as many times as needed
+ * 
+ * Once everything counted is read, the count is polled again. The chain
+ * stops when the GPS is empty, the ring is full, or a transaction fails.
+ * 
+ * Once the GPS drives TX-ready, its rising edge on INT1 starts the chain,
+ * so the port is only read when there is something to read. INT1 only
+ * notes the edge, and has the chain started from the I2C2 interrupt once
+ * the bus is idle, since the queue is only ever guarded against that
+ * interrupt. An edge that comes while the chain runs makes it count again
+ * rather than stop. Until then, and while a reply is awaited, the chain
+ * is restarted by the next call to gps_get_nmea, which polls.
+ * 
+ * The ring has a single producer (the interrupt) which only moves
+ * ringHead, and a single consumer (gps_get_nmea) which only moves
+ * ringTail, so neither needs to lock the other out.
+ */
+#define INGEST_IDLE  0
+#define INGEST_COUNT 1
+#define INGEST_DATA  2
+
+// Must be a power of 2, so indices can wrap freely
+#define GPS_RING_SIZE 512
+#define GPS_RING_MASK ( GPS_RING_SIZE - 1 )
+
+// The most a single TRB can read
+#define GPS_MAX_CHUNK 255
+
+static uint8_t           ring[GPS_RING_SIZE];
+static volatile uint16_t ringHead = 0;
+static volatile uint16_t ringTail = 0;
+
+static volatile uint8_t  ingestState = INGEST_IDLE;
+static volatile uint8_t  ingestPending = 0;
+static volatile uint8_t  txReady = 0;
+static volatile uint8_t  ingestHeld = 0;
+static uint8_t           ingestReg = REG_NUM_HIGH;
+static uint8_t           ingestNum[2];
+static uint16_t          ingestAvailable;
+static uint8_t           ingestChunk;
+static I2C_request_t     ingestRequest;
+
+// Sentences and frames are parsed as the ring is emptied
+static nmea_framer_t          framer;
+static ubx_parser_t           parser;
+static const nmea_sentence_t *sentence = NULL;
+static uint8_t                sentenceReady = 0;
+static ubx_nav_pvt_t          pvt;
+static uint8_t                pvtReady = 0;
+static gps_fix_t              fix;
+static uint8_t                fixReady = 0;
+
+/* Epochs
+ * 
+ * The output of an epoch is gathered as it is parsed, and published as a
+ * whole once NAV-EOE ends it, so GGA and RMC are never seen apart. Two
+ * records take turns, one being gathered while the other is published.
+ * After NAV-EOE the GPS has nothing more to say until the next epoch, so
+ * once gps_schedule is in use the port is left alone until then, unless a
+ * reply is awaited. ingestHeld says so to the I2C2 interrupt, which then
+ * leaves an edge of TX-ready pending until the next fix is due. From then
+ * until NAV-EOE the epoch is read in a pass per edge of TX-ready, or per
+ * poll without it.
+ */
+static gps_epoch_t epochs[2];
+static uint8_t     epochGathering = 0;
+static uint8_t     epochReady = 0;
+
+// Frames are built here before they are sent
+static uint8_t frameOut[UBX_MAX_PAYLOAD + UBX_OVERHEAD];
+
+/* Replies to UBX messages sent to the GPS
+ * 
+ * While a reply is awaited, the first frame of the awaited class and id
+ * is copied out of the parser. A reply is given up on once a time that
+ * suits the message has passed, measured with the ticks timebase so it
+ * does not depend on how fast we loop or the bus runs. Saving to the
+ * receiver's flash, and CFG-GNSS, which restarts the GNSS, take longest.
+ */
+#define GPS_REPLY_MS      250UL  // polls, and most configuration
+#define GPS_REPLY_SLOW_MS 1500UL // CFG-CFG saves and CFG-GNSS
+#define GPS_DUMP_GAP_MS   1000UL // between MGA-DBD frames, before the dump is over
+#define UBX_ANY_ID        0xFF
+
+static uint8_t           awaiting = 0;
+static uint8_t           awaitClass;
+static uint8_t           awaitId;
+static uint8_t           replyReady = 0;
+static ubx_frame_t       reply;
+
+/**
+ * Reads the count on the next transaction, to start counting again
+ */
+static void gps_ingest_recount( void ) {
+  ingestPending = 0;
+  ingestState = INGEST_COUNT;
 }
 
-uint8_t gps_get_nmea( char *buffer, const uint8_t n ) {
+/**
+ * Stops the ingestion chain, until it is started again
+ */
+static void gps_ingest_stop( void ) {
+  ingestState = INGEST_IDLE;
+}
+
+static void gps_ingest_next( uint8_t success, void *context );
+
+/**
+ * Queues the transaction of the current state of the ingestion chain
+ */
+static void gps_ingest_queue( void ) {
   
-  // keep track of the prior exchange, a $ may have been gobbled up
-  static uint8_t lastChar = 0;
+  uint8_t queued;
   
-  if( n == 0 ) return 1; //nonzero size
-  if( n == 1 ) { // buffer contains only null terminator
-    buffer[0] = 0;
-    return 1;
+  if( ingestState == INGEST_COUNT ) {
+    queued = I2C_write_read_async( &ingestRequest, GPS_ADDRESS, &ingestReg, 1, ingestNum, 2,
+        gps_ingest_next, NULL );
+  }
+  else {
+    queued = I2C_read_async( &ingestRequest, GPS_ADDRESS, ring + ( ringHead & GPS_RING_MASK ), ingestChunk,
+        gps_ingest_next, NULL );
   }
   
-  // keep track of the last character read, and the index into the line
-  uint8_t i = 0;
+  if( !queued ) gps_ingest_stop();
+}
+
+/**
+ * Moves the ingestion chain on to its next transaction
+ * Called from the I2C2 interrupt when the previous one completes
+ * @param success 1 if the previous transaction was successful
+ * @param context Unused
+ */
+static void gps_ingest_next( uint8_t success, void *context ) {
+  
+  uint16_t head;
+  uint16_t space;
   
-  // keep skipping until the first $
-  while( lastChar != '$' ) {
-    
-    // panic if I2C gives errors
-    if( !I2C_block_read( GPS_ADDRESS,  &lastChar, 1 ) ) return 0;
+  // stop on any error, the next gps_get_nmea will try again
+  if( !success ) {
+    gps_ingest_stop();
+    return;
   }
   
-  //now read the sentence, which ends in \r\n
-  do {
+  switch( ingestState ) {
+  case INGEST_COUNT:
+  case INGEST_DATA:
+    if( ingestState == INGEST_COUNT ) {
+      ingestAvailable = ( (uint16_t)ingestNum[0] << 8 ) | ingestNum[1];
+      
+      // TX-ready was raised after the count was read
+      if( !ingestAvailable && ingestPending ) {
+        gps_ingest_recount();
+        break;
+      }
+    }
+    else {
+      // commit the chunk just read, making it visible to the consumer
+      ringHead += ingestChunk;
+      ingestAvailable -= ingestChunk;
+      
+      // everything counted was read, so check for more
+      if( !ingestAvailable ) {
+        gps_ingest_recount();
+        break;
+      }
+    }
+    
+    // read as much as fits before the end of the ring
+    head = ringHead & GPS_RING_MASK;
+    space = GPS_RING_SIZE - (uint16_t)( ringHead - ringTail );
+    if( space > GPS_RING_SIZE - head ) space = GPS_RING_SIZE - head;
+    if( space > ingestAvailable ) space = ingestAvailable;
+    if( space > GPS_MAX_CHUNK ) space = GPS_MAX_CHUNK;
+    
+    // GPS is empty, or the ring is full
+    if( !space ) {
+      gps_ingest_stop();
+      return;
+    }
+    
+    ingestChunk = (uint8_t)space;
+    ingestState = INGEST_DATA;
+    break;
     
-    //skip empty data
-    if( lastChar != NO_DATA ) {
-      buffer[i] = lastChar;
-      printf( "%c", lastChar );
-      i++;
-      buffer[i] = 0; // pad line with null at every step
+  default:
+    return;
+  }
+  
+  gps_ingest_queue();
+}
+
+/**
+ * Starts the ingestion chain
+ * Precondition: The chain is idle
+ */
+static void gps_ingest_begin( void ) {
+  gps_ingest_recount();
+  gps_ingest_queue();
+}
+
+/**
+ * Notes a rising edge of TX-ready, for the I2C2 interrupt to act on
+ * Called from the INT1 interrupt
+ */
+void EX_INT1_CallBack( void ) {
+  
+  if( !txReady ) return;
+  
+  ingestPending = 1;
+  I2C2_MasterIdleRequest();
+}
+
+/**
+ * Starts the ingestion chain for an edge of TX-ready
+ * Called from the I2C2 interrupt, whenever the bus goes idle
+ */
+void I2C2_MasterIdleCallBack( void ) {
+  if( txReady && ingestPending && !ingestHeld && ingestState == INGEST_IDLE ) gps_ingest_begin();
+}
+
+/**
+ * Decides whether the port is left alone, as no fix is due yet
+ * @return 1 if it is, 0 otherwise
+ */
+static uint8_t gps_ingest_hold( void ) {
+  ingestHeld = scheduled && !awaiting && (int32_t)( scheduleNow - nextFixDue ) < 0;
+  return ingestHeld;
+}
+
+/**
+ * Starts the ingestion chain, if it is not already running and there may
+ * be something to read
+ */
+static void gps_ingest_start( void ) {
+  
+  uint8_t start;
+  uint8_t enabled = IEC3bits.MI2C2IE;
+  
+  // keep the I2C2 interrupt from starting the chain between the check
+  // and the start
+  IEC3bits.MI2C2IE = 0;
+  
+  // leave the port alone until the next fix is due, unless a reply is
+  // awaited, whether or not TX-ready is up
+  if( gps_ingest_hold() ) start = 0;
+  
+  // TX-ready stays high if the ring filled up, or an edge was held or missed
+  else if( txReady && !awaiting ) start = GPS_TXREADY_GetValue() || ingestPending;
+  
+  else start = 1;
+  
+  if( start && ingestState == INGEST_IDLE ) gps_ingest_begin();
+  
+  IEC3bits.MI2C2IE = enabled;
+}
+
+/**
+ * Waits for the ingestion chain to stop, so the bus is free for others
+ */
+static void gps_ingest_wait( void ) {
+  while( ingestState != INGEST_IDLE ) I2C_service();
+}
+
+/**
+ * Takes the next char out of the ring
+ * @param c Where the char will be saved
+ * @return 1 if there was a char, 0 if the ring is empty
+ */
+static uint8_t gps_ring_pop( uint8_t *c ) {
+  
+  if( ringTail == ringHead ) return 0;
+  
+  *c = ring[ringTail & GPS_RING_MASK];
+  ringTail++;
+  return 1;
+}
+
+/**
+ * When the port should be polled again, shortly before the next fix
+ * @param period The time until the next fix, in ms
+ * @return The time to poll again, in ms
+ */
+static uint32_t gps_next_due( const uint32_t period ) {
+  
+  uint32_t margin = period / GPS_WAKE_DIVISOR;
+  if( margin > GPS_WAKE_MARGIN ) margin = GPS_WAKE_MARGIN;
+  
+  return scheduleNow + period - margin;
+}
+
+/**
+ * Notes that the fix was updated
+ * 
+ * When the next one is due is only known once NAV-EOE ends the epoch, as
+ * the rest of the epoch must still be read.
+ */
+static void gps_fix_updated( void ) {
+  fixReady = 1;
+}
+
+/**
+ * Publishes the epoch gathered, and starts gathering the next one
+ * @param iTOW The GPS time of week of the epoch, in ms
+ */
+static void gps_epoch_ended( const uint32_t iTOW ) {
+  
+  gps_epoch_t *gathered = &epochs[epochGathering];
+  
+  gathered->iTOW = iTOW;
+  gathered->fix = fix;
+  epochReady = 1;
+  
+  epochGathering ^= 1;
+  epochs[epochGathering].gga.length = 0;
+  epochs[epochGathering].rmc.length = 0;
+  
+  nextFixDue = gps_next_due( updatePeriod ? updatePeriod : epochPeriod );
+  gps_ingest_hold();
+}
+
+/**
+ * Keeps track of the sentence the framer just completed
+ * @param s The sentence
+ * @param context Unused
+ */
+static void gps_sentence_ready( const nmea_sentence_t *s, void *context ) {
+  sentence = s;
+  sentenceReady = 1;
+  
+  // merge GGA and RMC into the fix as they come
+  if( !nmea_decode( s, &fix ) ) return;
+  gps_fix_updated();
+  
+  if( nmea_is( s, "GGA" ) ) epochs[epochGathering].gga = *s;
+  else epochs[epochGathering].rmc = *s;
+}
+
+/**
+ * Keeps the latest navigation solution the parser delivers, as is and as
+ * a fix, and any reply being awaited
+ * @param frame The frame
+ * @param context Unused
+ */
+static void gps_frame_ready( const ubx_frame_t *frame, void *context ) {
+  
+  // hold on to an awaited reply
+  if( awaiting && !replyReady && frame->msgClass == awaitClass
+      && ( awaitId == UBX_ANY_ID || frame->msgId == awaitId ) ) {
+    reply = *frame;
+    replyReady = 1;
+  }
+  
+  if( frame->msgClass == UBX_CLASS_NAV && frame->msgId == UBX_NAV_EOE && frame->length >= 4 ) {
+    gps_epoch_ended( ubx_u4( frame->payload ) );
+    return;
+  }
+  
+  if( !ubx_decode_nav_pvt( frame, &pvt ) ) return;
+  
+  pvtReady = 1;
+  ubx_pvt_to_fix( &pvt, &fix );
+  gps_fix_updated();
+}
+
+/**
+ * Feeds the ring through the framer and parser, until done is set or the
+ * ring is empty
+ * @param done The flag to stop on
+ */
+static void gps_pump( const uint8_t *done ) {
+  
+  uint8_t c;
+  
+  // a transfer of the chain that is stuck fails once its deadline passes,
+  // which lets the chain stop and be started again
+  I2C_service();
+  
+  // keep the GPS flowing into the ring in the background
+  gps_ingest_start();
+  
+  while( !*done && gps_ring_pop( &c ) ) {
+    nmea_framer_push( &framer, c );
+    ubx_parser_push( &parser, c );
+  }
+}
+
+/**
+ * Sends the frame in frameOut to the GPS
+ * @param n The length of the frame
+ * @return 1 if the transaction was successful, 0 otherwise
+ */
+static uint8_t gps_send_frame( const uint16_t n ) {
+  gps_ingest_wait();
+  return I2C_block_write( GPS_ADDRESS, frameOut, n );
+}
+
+/**
+ * Sends a UBX message to the GPS
+ * @param msgClass The message class
+ * @param msgId The message id
+ * @param payload The payload
+ * @param length The payload length
+ * @return 1 if the transaction was successful, 0 otherwise
+ */
+static uint8_t gps_send_ubx( const uint8_t msgClass, const uint8_t msgId,
+                             const uint8_t *payload, const uint16_t length ) {
+  return gps_send_frame( ubx_build( frameOut, msgClass, msgId, payload, length ) );
+}
+
+/**
+ * Waits for a UBX message from the GPS
+ * @param msgClass The message class
+ * @param msgId The message id, or UBX_ANY_ID
+ * @param timeout How long to wait for it, in ms
+ * @return 1 if the message arrived, and is in reply, 0 if it did not
+ */
+static uint8_t gps_await( const uint8_t msgClass, const uint8_t msgId, const uint32_t timeout ) {
+  
+  ticks_t start = now_ticks();
+  ticks_t wait = timeout * 1000UL * TICKS_PER_US;
+  
+  awaitClass = msgClass;
+  awaitId = msgId;
+  replyReady = 0;
+  awaiting = 1;
+  
+  while( !replyReady && ticks_since( start ) < wait ) {
+    gps_pump( &replyReady );
+  }
+  
+  awaiting = 0;
+  return replyReady;
+}
+
+/**
+ * Sends a UBX-CFG message and waits for the GPS to accept it
+ * @param msgId The message id, in the CFG class
+ * @param payload The payload
+ * @param length The payload length
+ * @return 1 if the GPS acknowledged the message, 0 otherwise
+ */
+static uint8_t gps_configure( const uint8_t msgId, const uint8_t *payload, const uint16_t length ) {
+  
+  uint32_t timeout = ( msgId == UBX_CFG_CFG || msgId == UBX_CFG_GNSS ) ? GPS_REPLY_SLOW_MS : GPS_REPLY_MS;
+  
+  if( !gps_send_ubx( UBX_CLASS_CFG, msgId, payload, length ) ) return 0;
+  
+  // an ACK names the message it answers, skip any others
+  while( gps_await( UBX_CLASS_ACK, UBX_ANY_ID, timeout ) ) {
+    if( reply.length == 2 && reply.payload[0] == UBX_CLASS_CFG && reply.payload[1] == msgId ) {
+      return ( reply.msgId == UBX_ACK_ACK );
     }
+  }
+  
+  return 0;
+}
+
+/**
+ * Polls a UBX message from the GPS
+ * @param msgClass The message class
+ * @param msgId The message id
+ * @param payload The payload of the poll request
+ * @param length The payload length
+ * @return 1 if the GPS answered, and the answer is in reply, 0 otherwise
+ */
+static uint8_t gps_poll( const uint8_t msgClass, const uint8_t msgId,
+                         const uint8_t *payload, const uint16_t length ) {
+  
+  if( !gps_send_ubx( msgClass, msgId, payload, length ) ) return 0;
+  return gps_await( msgClass, msgId, GPS_REPLY_MS );
+}
+
+/**
+ * Builds the CFG-PRT payload for the DDC port
+ * @param payload Where the 20 bytes of payload will be saved
+ * @param outProtoMask The protocols to output
+ */
+static void gps_cfg_prt_ddc( uint8_t *payload, const uint8_t outProtoMask ) {
+  
+  uint8_t i;
+  
+  for( i = 0; i < 20; i++ ) payload[i] = 0;
+  
+  payload[0] = 0x00;                // portID: DDC
+  payload[2] = (uint8_t)TXREADY_FIELD;          // txReady
+  payload[3] = (uint8_t)( TXREADY_FIELD >> 8 );
+  payload[4] = GPS_ADDRESS << 1;    // mode: slave address
+  payload[12] = PROTO_UBX | PROTO_NMEA; // inProtoMask
+  payload[14] = outProtoMask;       // outProtoMask
+}
+
+/**
+ * The protocols output on the DDC port in a mode
+ * @param mode GPS_MODE_NMEA or GPS_MODE_UBX
+ * @return The outProtoMask of CFG-PRT
+ */
+static uint8_t gps_out_proto( const uint8_t mode ) {
+  return ( mode == GPS_MODE_UBX ) ? PROTO_UBX : ( PROTO_UBX | PROTO_NMEA );
+}
+
+/**
+ * Checks the dynamic platform model of the GPS
+ * @return 1 if it is GPS_DYN_MODEL, 0 if not or it could not be read
+ */
+static uint8_t gps_dyn_model_matches( void ) {
+  if( !gps_poll( UBX_CLASS_CFG, UBX_CFG_NAV5, NULL, 0 ) ) return 0;
+  return ( reply.length == NAV5_LENGTH && reply.payload[2] == GPS_DYN_MODEL );
+}
+
+/**
+ * Sets the dynamic platform model of the GPS, and reads it back
+ * @return 1 if the GPS uses GPS_DYN_MODEL, 0 otherwise
+ */
+static uint8_t gps_set_dyn_model( void ) {
+  
+  uint8_t nav5[NAV5_LENGTH];
+  uint8_t i;
+  
+  for( i = 0; i < sizeof( nav5 ); i++ ) nav5[i] = 0;
+  
+  // only the model is applied, the rest is left as it is
+  nav5[0] = (uint8_t)NAV5_MASK_DYN;  // mask
+  nav5[1] = (uint8_t)( NAV5_MASK_DYN >> 8 );
+  nav5[2] = GPS_DYN_MODEL;           // dynModel
+  
+  if( !gps_configure( UBX_CFG_NAV5, nav5, sizeof( nav5 ) ) ) return 0;
+  return gps_dyn_model_matches();
+}
+
+/**
+ * Checks if the GPS already has the configuration of a mode
+ * 
+ * Everything is saved at once by CFG-CFG, so it is enough to check the
+ * port, and a message whose rate differs from the default.
+ * 
+ * @param mode GPS_MODE_NMEA or GPS_MODE_UBX
+ * @return 1 if it does, 0 if it does not or could not be read
+ */
+static uint8_t gps_config_matches( const uint8_t mode ) {
+  
+  uint8_t poll[2];
+  
+  // CFG-PRT is polled with the port id
+  poll[0] = 0x00;
+  if( !gps_poll( UBX_CLASS_CFG, UBX_CFG_PRT, poll, 1 ) ) return 0;
+  if( reply.length != 20 || reply.payload[14] != gps_out_proto( mode ) ) return 0;
+  if( ubx_u2( reply.payload + 2 ) != TXREADY_FIELD ) return 0;
+  
+  // CFG-MSG is polled with the message, and answers with the rate on
+  // every port, DDC being the first
+  if( mode == GPS_MODE_UBX ) {
+    poll[0] = UBX_CLASS_NAV;
+    poll[1] = UBX_NAV_PVT;
+  }
+  else {
+    poll[0] = UBX_CLASS_NMEA;
+    poll[1] = NMEA_GSV;
+  }
+  if( !gps_poll( UBX_CLASS_CFG, UBX_CFG_MSG, poll, 2 ) ) return 0;
+  if( reply.length != 8 ) return 0;
+  if( reply.payload[2] != ( ( mode == GPS_MODE_UBX ) ? 1 : 0 ) ) return 0;
+  
+  // and the end of epoch marker, in both modes
+  if( !gps_poll( UBX_CLASS_CFG, UBX_CFG_MSG, CFG_MSG_NAV_EOE, 2 ) ) return 0;
+  if( reply.length != 8 || reply.payload[2] != 1 ) return 0;
+  
+  return gps_dyn_model_matches();
+}
+
+uint8_t gps_init( const uint8_t mode ) {
+  
+  uint8_t prt[20];
+  uint8_t msg[3];
+  uint8_t i;
+  
+  nmea_framer_init( &framer, gps_sentence_ready, NULL );
+  ubx_parser_init( &parser, gps_frame_ready, NULL );
+  I2C2_SlaveSpeedSet( GPS_ADDRESS, GPS_I2C_SPEED );
+  
+  // poll until the GPS is known to drive TX-ready
+  txReady = 0;
+  
+  // the configuration was saved by an earlier boot
+  if( gps_config_matches( mode ) ) {
+    txReady = 1;
+    return 1;
+  }
+  
+  gps_cfg_prt_ddc( prt, gps_out_proto( mode ) );
+  if( !gps_configure( UBX_CFG_PRT, prt, sizeof( prt ) ) ) return 0;
+  txReady = 1;
+  
+  if( mode == GPS_MODE_UBX ) {
+    if( !gps_configure( UBX_CFG_MSG, CFG_MSG_NAV_PVT, sizeof( CFG_MSG_NAV_PVT ) ) ) return 0;
+  }
+  else {
+    msg[0] = UBX_CLASS_NMEA;
+    for( i = 0; i < sizeof( NMEA_RATES ) / sizeof( NMEA_RATES[0] ); i++ ) {
+      msg[1] = NMEA_RATES[i][0];
+      msg[2] = NMEA_RATES[i][1];
+      if( !gps_configure( UBX_CFG_MSG, msg, sizeof( msg ) ) ) return 0;
+    }
+  }
+  
+  if( !gps_configure( UBX_CFG_MSG, CFG_MSG_NAV_EOE, sizeof( CFG_MSG_NAV_EOE ) ) ) return 0;
+  if( !gps_set_dyn_model() ) return 0;
+  
+  return gps_configure( UBX_CFG_CFG, CFG_CFG_SAVE, sizeof( CFG_CFG_SAVE ) );
+}
+
+uint8_t gps_set_update_period( const uint32_t period ) {
+  
+  uint8_t pm2[44];
+  uint8_t rxm[2];
+  uint32_t flags;
+  uint8_t i;
+  
+  if( period ) {
+    
+    for( i = 0; i < sizeof( pm2 ); i++ ) pm2[i] = 0;
     
-    // continue reading one char at a time
-    if( !I2C_block_read( GPS_ADDRESS, &lastChar, 1 ) ) return 0;
+    // keep the RTC and ephemeris up to date while off, so fixes come quickly
+    flags = PM2_UPDATE_RTC | PM2_UPDATE_EPH;
+    flags |= ( period <= PM2_CYCLIC_MAX_PERIOD ) ? PM2_MODE_CYCLIC : PM2_MODE_ONOFF;
     
-  } while( lastChar != '\r' && lastChar != '$' && i < (n-1) );
+    pm2[0] = 0x01;                                  // version
+    for( i = 0; i < 4; i++ ) {
+      pm2[4 + i]  = (uint8_t)( flags >> ( 8 * i ) );  // flags
+      pm2[8 + i]  = (uint8_t)( period >> ( 8 * i ) ); // updatePeriod, ms
+      pm2[12 + i] = (uint8_t)( period >> ( 8 * i ) ); // searchPeriod, ms
+    }
+    
+    if( !gps_configure( UBX_CFG_PM2, pm2, sizeof( pm2 ) ) ) return 0;
+  }
   
-  //either lastChar = \r, lastChar = $, or i == n
+  rxm[0] = 0x08;                 // reserved
+  rxm[1] = period ? 0x01 : 0x00; // lpMode: power save, or continuous
+  if( !gps_configure( UBX_CFG_RXM, rxm, sizeof( rxm ) ) ) return 0;
   
+  updatePeriod = period;
+  nextFixDue = scheduleNow;
   return 1;
 }
 
 /**
- * Small Hex String-to-Int conversion
- * Assumes characters involved are only hex, and null-terminated
- * @param str The string to convert
- * @return The numeric value of the string
- */
-inline uint8_t small_shtoui( const char *str, uint8_t len ) {
-  
-  // running total
-  uint8_t val = 0;
-  
-  // what power of 16 are we testing
-  uint8_t place = 1;
-  
-  // run through whole string
-  uint8_t i = len - 1;
-  while( i >= 0 ) {
-    
-    switch( str[i] ) {
-    case '0': continue;
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-      val += ((str[i] - '0') * place);
-      break;
-    case 'A':
-      val += (0xA * place);
-      break;
-    case 'B':
-      val += (0xB * place);
-      break;
-    case 'C':
-      val += (0xC * place);
-      break;
-    case 'D':
-      val += (0xD * place);
-      break;
-    case 'E':
-      val += (0xE * place);
-      break;
-    case 'F':
-      val += (0xF * place);
-      break;
-    default:
-      return 0;
+ * Reads the constellations the GPS tracks
+ * @param gnss Where the GPS_GNSS_* flags will be saved
+ * @return 1 if the GPS answered, 0 otherwise
+ */
+static uint8_t gps_read_gnss( uint8_t *gnss ) {
+  
+  const uint8_t *block;
+  uint8_t count;
+  uint8_t i, j;
+  
+  if( !gps_poll( UBX_CLASS_CFG, UBX_CFG_GNSS, NULL, 0 ) ) return 0;
+  if( reply.length < GNSS_HEADER ) return 0;
+  
+  count = reply.payload[3];
+  if( reply.length < GNSS_HEADER + count * GNSS_BLOCK ) return 0;
+  
+  *gnss = 0;
+  for( i = 0; i < count; i++ ) {
+    block = reply.payload + GNSS_HEADER + i * GNSS_BLOCK;
+    if( !( block[4] & GNSS_ENABLE ) ) continue;
+    
+    // only the main constellations are reported, not their augmentations
+    for( j = 0; j < GNSS_BLOCK_COUNT; j++ ) {
+      if( GNSS_BLOCKS[j][0] == block[0] && GNSS_BLOCKS[j][0] != GNSS_ID_SBAS
+          && GNSS_BLOCKS[j][0] != GNSS_ID_QZSS ) *gnss |= GNSS_BLOCKS[j][3];
     }
-      place <<= 4; // place *= 16
-      i--;
   }
   
-  return val;
+  return 1;
 }
 
-uint8_t nmea_validate( const char *sentence ) {
+uint8_t gps_set_gnss( const uint8_t gnss ) {
   
-  //all NMEA sentences start with $
-  if( sentence[0] != '$' ) return 0;
+  uint8_t payload[GNSS_HEADER + GNSS_BLOCK_COUNT * GNSS_BLOCK];
+  uint8_t *block;
+  uint8_t current;
+  uint8_t i, j;
   
-  //find the checksum
-  const char *s = sentence;
-  while( *s != '*' && *s != 0 ) s++;
-  if( *s == 0 ) return 0;
-  char val[2] = { *s, *(s+1) };
+  // the receiver cannot track both at once
+  if( ( gnss & GPS_GNSS_GLONASS ) && ( gnss & GPS_GNSS_BEIDOU ) ) return 0;
+  if( !gnss ) return 0;
+  
+  // applying a selection restarts the receiver, so skip it if unchanged
+  if( gps_read_gnss( &current ) && current == gnss ) {
+    gnssTracked = gnss;
+    return 1;
+  }
   
-  uint8_t checksum = small_shtoui( val, 2 );
+  for( i = 0; i < sizeof( payload ); i++ ) payload[i] = 0;
   
-  if( checksum == 0 ) return 0;
+  payload[0] = 0x00;             // msgVer
+  payload[2] = 0xFF;             // numTrkChUse: every channel there is
+  payload[3] = GNSS_BLOCK_COUNT; // numConfigBlocks
   
-  //calculate the checksum from the rest of the string
-  uint8_t sum = 0;
-  const char *b = sentence + 1; //skip '$'
-  char c;
-  while( (c = *b) != 0 && c != '*' ) {
-    if( c != ',' ) sum ^= c;
-    b++;
+  for( i = 0; i < GNSS_BLOCK_COUNT; i++ ) {
+    block = payload + GNSS_HEADER + i * GNSS_BLOCK;
+    for( j = 0; j < 3; j++ ) block[j] = GNSS_BLOCKS[i][j]; // gnssId, resTrkCh, maxTrkCh
+    block[4] = ( gnss & GNSS_BLOCKS[i][3] ) ? GNSS_ENABLE : 0; // flags
+    block[6] = GNSS_SIG_L1;
   }
   
-  //compare the checksums
-  return ( sum == checksum );
+  if( !gps_configure( UBX_CFG_GNSS, payload, sizeof( payload ) ) ) return 0;
+  gnssTracked = gnss;
+  
+  return gps_configure( UBX_CFG_CFG, CFG_CFG_SAVE, sizeof( CFG_CFG_SAVE ) );
+}
+
+uint8_t gps_get_diagnostics( gps_diagnostics_t *diagnostics ) {
+  
+  if( !gps_poll( UBX_CLASS_NAV, UBX_NAV_STATUS, NULL, 0 ) ) return 0;
+  if( reply.length < UBX_NAV_STATUS_LENGTH ) return 0;
+  
+  diagnostics->ttff = ubx_u4( reply.payload + 8 );
+  diagnostics->msss = ubx_u4( reply.payload + 12 );
+  
+  // read back once, if never selected since boot
+  if( !gnssTracked ) gps_read_gnss( &gnssTracked );
+  diagnostics->gnss = gnssTracked;
+  diagnostics->numSV = fix.numSV;
+  
+  return 1;
+}
+
+/**
+ * Appends bytes to the aiding store, writing every double word as it fills
+ * @param data The bytes
+ * @param n The number of bytes
+ * @param base The program memory address of the store
+ * @return 1 if they were written, 0 otherwise
+ */
+static uint8_t gps_aid_append( const uint8_t *data, const uint16_t n, const uint32_t base ) {
+  
+  uint16_t i;
+  uint32_t address;
+  
+  for( i = 0; i < n; i++ ) {
+    aidPending[aidFill++] = data[i];
+    if( aidFill < 4 ) continue;
+    
+    address = base + GPS_AID_HEADER + aidLength + i + 1 - 4;
+    if( !FLASH_write_double( address,
+                             aidPending[0] | ( (uint16_t)aidPending[1] << 8 ),
+                             aidPending[2] | ( (uint16_t)aidPending[3] << 8 ) ) ) return 0;
+    aidFill = 0;
+  }
+  
+  aidLength += n;
+  return 1;
+}
+
+/**
+ * Reads bytes from the aiding store
+ * @param offset The offset of the first byte, after the header
+ * @param data Where the bytes will be saved
+ * @param n The number of bytes
+ * @param base The program memory address of the store
+ */
+static void gps_aid_read( uint16_t offset, uint8_t *data, const uint16_t n, const uint32_t base ) {
+  
+  uint16_t i;
+  uint16_t word;
+  
+  for( i = 0; i < n; i++, offset++ ) {
+    word = FLASH_read_word( base + ( ( GPS_AID_HEADER + offset ) & ~1UL ) );
+    data[i] = ( offset & 1 ) ? (uint8_t)( word >> 8 ) : (uint8_t)word;
+  }
+}
+
+/**
+ * Finds the program memory address of an aiding store
+ * @param store The store, from 0 to GPS_AID_STORES - 1
+ * @return Its address
+ */
+static uint32_t gps_aid_base( const uint8_t store ) {
+  return __builtin_tbladdress( aidStore ) + store * GPS_AID_PAGES * FLASH_PAGE_ADDRESSES;
+}
+
+/**
+ * Finds the newest complete aiding store
+ * @param base Where its program memory address will be saved
+ * @param sequence Where its sequence number will be saved
+ * @return 1 if a store holds a complete dump, 0 otherwise
+ */
+static uint8_t gps_aid_find( uint32_t *base, uint16_t *sequence ) {
+  
+  uint32_t address;
+  uint16_t number;
+  uint8_t found = 0;
+  uint8_t store;
+  
+  for( store = 0; store < GPS_AID_STORES; store++ ) {
+    address = gps_aid_base( store );
+    if( FLASH_read_word( address ) != GPS_AID_MAGIC ) continue;
+    if( FLASH_read_word( address + 2 ) > GPS_AID_CAPACITY ) continue;
+    
+    // the numbers wrap, and the two stores are always one apart
+    number = FLASH_read_word( address + 4 );
+    if( found && (int16_t)( number - *sequence ) <= 0 ) continue;
+    
+    *base = address;
+    *sequence = number;
+    found = 1;
+  }
+  
+  return found;
+}
+
+uint8_t gps_save_aiding( void ) {
+  
+  uint32_t used;
+  uint32_t base;
+  uint16_t sequence = 0;
+  uint8_t inUse = gps_aid_find( &used, &sequence );
+  uint16_t n;
+  uint8_t i;
+  
+  // dump over the older store, so the newest stays until this completes
+  base = ( inUse && used == gps_aid_base( 0 ) ) ? gps_aid_base( 1 ) : gps_aid_base( 0 );
+  sequence++;
+  
+  for( i = 0; i < GPS_AID_PAGES; i++ ) {
+    if( !FLASH_erase_page( base + i * FLASH_PAGE_ADDRESSES ) ) return 0;
+  }
+  
+  aidLength = 0;
+  aidFill = 0;
+  
+  // the dump is a run of frames, and ends when the GPS goes quiet
+  if( !gps_send_ubx( UBX_CLASS_MGA, UBX_MGA_DBD, NULL, 0 ) ) return 0;
+  
+  while( gps_await( UBX_CLASS_MGA, UBX_MGA_DBD, GPS_DUMP_GAP_MS ) ) {
+    
+    // keep whole frames only, the rest of the dump is parsed and ignored
+    n = ubx_build( frameOut, reply.msgClass, reply.msgId, reply.payload, reply.length );
+    if( aidLength + n > GPS_AID_CAPACITY ) break;
+    
+    if( !gps_aid_append( frameOut, n, base ) ) return 0;
+  }
+  
+  if( !aidLength ) return 0;
+  
+  // pad out the last double word
+  while( aidFill ) {
+    frameOut[0] = 0xFF;
+    if( !gps_aid_append( frameOut, 1, base ) ) return 0;
+  }
+  
+  // the sequence number makes the store the newest, once it is complete
+  if( !FLASH_write_double( base + 4, sequence, 0xFFFF ) ) return 0;
+  return FLASH_write_double( base, GPS_AID_MAGIC, aidLength );
+}
+
+uint8_t gps_restore_aiding( const gps_fix_t *now ) {
+  
+  uint32_t base;
+  uint16_t sequence;
+  uint8_t ini[24];
+  uint16_t length;
+  uint16_t offset;
+  uint16_t n;
+  uint8_t i;
+  
+  if( !gps_aid_find( &base, &sequence ) ) return 0;
+  length = FLASH_read_word( base + 2 );
+  
+  // the time first, so the GPS knows which of the data is current
+  if( now && ( now->valid & ( FIX_VALID_TIME | FIX_VALID_DATE ) ) == ( FIX_VALID_TIME | FIX_VALID_DATE ) ) {
+    
+    for( i = 0; i < sizeof( ini ); i++ ) ini[i] = 0;
+    
+    ini[0] = MGA_INI_TIME_UTC;                  // type
+    ini[2] = 0x00;                              // ref: on receipt of the message
+    ini[3] = 0x80;                              // leapSecs: unknown
+    ini[4] = (uint8_t)now->year;
+    ini[5] = (uint8_t)( now->year >> 8 );
+    ini[6] = now->month;
+    ini[7] = now->day;
+    ini[8] = (uint8_t)( now->time / 3600 );     // hour
+    ini[9] = (uint8_t)( now->time / 60 % 60 );  // minute
+    ini[10] = (uint8_t)( now->time % 60 );      // second
+    ini[16] = GPS_AID_TIME_ACC;                 // tAccS
+    
+    if( !gps_send_ubx( UBX_CLASS_MGA, UBX_MGA_INI, ini, sizeof( ini ) ) ) return 0;
+  }
+  
+  // the frames are sent back as they were dumped, one write each
+  for( offset = 0; offset + UBX_OVERHEAD <= length; offset += n ) {
+    
+    gps_aid_read( offset, frameOut, 6, base );
+    if( frameOut[0] != UBX_SYNC_1 || frameOut[1] != UBX_SYNC_2 ) return 0;
+    
+    n = ubx_u2( frameOut + 4 ) + UBX_OVERHEAD;
+    if( n > sizeof( frameOut ) || offset + n > length ) return 0;
+    
+    gps_aid_read( offset, frameOut, n, base );
+    if( !gps_send_frame( n ) ) return 0;
+  }
+  
+  return 1;
+}
+
+uint8_t gps_set_rate( const uint16_t period ) {
+  
+  uint8_t rate[6];
+  
+  if( period < GPS_RATE_MIN_PERIOD || period > GPS_RATE_MAX_PERIOD ) return 0;
+  
+  rate[0] = (uint8_t)period;          // measRate, ms
+  rate[1] = (uint8_t)( period >> 8 );
+  rate[2] = 1;                        // navRate: a solution every measurement
+  rate[3] = 0;
+  rate[4] = RATE_TIME_GPS;            // timeRef
+  rate[5] = 0;
+  
+  if( !gps_configure( UBX_CFG_RATE, rate, sizeof( rate ) ) ) return 0;
+  
+  epochPeriod = period;
+  nextFixDue = scheduleNow;
+  return 1;
+}
+
+uint8_t gps_schedule( const uint32_t now ) {
+  
+  scheduleNow = now;
+  scheduled = 1;
+  
+  // let the I2C2 interrupt read the port again once a fix is due
+  gps_ingest_hold();
+  return (int32_t)( now - nextFixDue ) >= 0;
+}
+
+uint8_t gps_get_nmea( char *buffer, const uint8_t n ) {
+  
+  uint8_t i;
+  
+  if( n == 0 ) return 0; //nonzero size
+  
+  // a completed sentence stays valid in the framer until the next char
+  // is pushed, which is why the pump stops right after it
+  sentenceReady = 0;
+  gps_pump( &sentenceReady );
+  if( !sentenceReady ) return 0;
+  
+  for( i = 0; i < sentence->length && i < (n-1); i++ ) buffer[i] = sentence->text[i];
+  buffer[i] = 0;
+  
+  return 1;
+}
+
+uint8_t gps_get_pvt( ubx_nav_pvt_t *solution ) {
+  
+  gps_pump( &pvtReady );
+  if( !pvtReady ) return 0;
+  
+  *solution = pvt;
+  pvtReady = 0;
+  
+  return 1;
+}
+
+uint8_t gps_get_fix( gps_fix_t *current ) {
+  
+  gps_pump( &fixReady );
+  if( !fixReady ) return 0;
+  
+  *current = fix;
+  fixReady = 0;
+  
+  return 1;
+}
+
+uint8_t gps_get_epoch( gps_epoch_t *epoch ) {
+  
+  gps_pump( &epochReady );
+  if( !epochReady ) return 0;
+  
+  *epoch = epochs[epochGathering ^ 1];
+  epochReady = 0;
+  
+  return 1;
 }
\ No newline at end of file
@@ -1,13 +1,15 @@
 /* 
  * File:     gps.h
  * Author:   Christopher Madrigal
- * Modified: 20 February 2020
+ * Modified: 17 October 2026
  */
 
 #ifndef GPS_H
 #define	GPS_H
 
 #include <stdint.h>
+#include "nmea.h"
+#include "ubx.h"
     
 /*
  * The GPS unit receives GPS data and outputs NMEA Sentences
@@ -20,7 +22,7 @@
  *         or a custom command name
  *       [field_i] is the i-th field's value
  *       N is a checksum of the entire sentence between
- *         the '$' and '*' not including ','
+ *         the '$' and '*'
  *       The ',' '$' '*' and "\r\n" literals are required
  *
  * The checksum N is calculated by applying a running XOR to every
@@ -29,8 +31,7 @@
  *   let subsentence := substring( sentence, '$', '*' );
  *   let checksum := 0;
  *   for( char c in subsentence )
- *     if( c != ',' )
- *       checksum := checksum XOR c
+ *     checksum := checksum XOR c
  * 
  * Where substring( s, c1, c2 ) gives the sequence of
  *   characters in s between c1 and c2, not counting c1 nor c2
@@ -40,8 +41,6 @@
  *   immediately with "\r\n"
  * 
  * Any field without valid data is left empty, but is still delimited by a ','
- * This has the added benefit of ensuring any empty message, though well
- *   formatted, has a checksum of identically 0.
  * 
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * 
@@ -57,47 +56,281 @@
  *   sentences verbatim through telemetry.
  */
 
+/*
+ * Instead of NMEA, the GPS can be set to output a single binary UBX-NAV-PVT
+ * message per navigation epoch (see ubx.h). It is about 100 bytes, rather
+ * than about 150 for GGA and RMC, and every field already comes as a
+ * scaled integer, so there is no text to parse.
+ */
+#define GPS_MODE_NMEA 0
+#define GPS_MODE_UBX  1
+
 /**
  * Initialize the GPS.
  * 
+ * The configuration is saved in the GPS, which keeps it across resets in
+ * battery-backed RAM and flash. If the GPS already has it, from an earlier
+ * boot, nothing is sent. It includes the airborne dynamic platform model,
+ * without which the GPS gives up on fixes above 12 km or 310 m/s.
+ * 
  * Precondition:
  *   I2C peripheral must be initialized.
  * 
  * Postcondition:
  *   GPS will be initialized to the desired configuration.
- *   gps_get_line will return the next valid NMEA Sentence.
+ *   In GPS_MODE_NMEA, gps_get_nmea will return the next valid NMEA Sentence.
+ *   In GPS_MODE_UBX, gps_get_pvt will return the next navigation solution.
+ * 
+ * @param mode GPS_MODE_NMEA or GPS_MODE_UBX
+ * @return 1 if the GPS accepted every setting, 0 otherwise
+ */
+uint8_t gps_init( const uint8_t mode );
+
+/**
+ * Duty cycle the GPS to save power
+ * 
+ * With a nonzero period, the GPS only computes a fix once per period and
+ * saves power in between: by cyclic tracking for periods up to 10 s, or by
+ * switching off and reacquiring for longer ones. The period should match
+ * how often fixes are sent through telemetry.
+ * 
+ * The GPS supports power save with GPS alone, or with GLONASS on some
+ * firmware versions, but not with other constellations enabled.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   While the period is nonzero, the DDC port is not polled until shortly
+ *     before the next fix is due, which gps_schedule needs to know.
+ * 
+ * @param period The update period in ms, or 0 to track continuously
+ * @return 1 if the GPS accepted the settings, 0 otherwise
  */
-void gps_init( void );
+uint8_t gps_set_update_period( const uint32_t period );
+
+// Fastest and slowest navigation rates, as the time between epochs in ms
+#define GPS_RATE_MIN_PERIOD 100
+#define GPS_RATE_MAX_PERIOD 1000
 
 /**
- * Read an NMEA sentence from the GPS
+ * Set how often the GPS computes a navigation solution
+ * 
+ * A high rate suits critical phases of the mission, and a slow one the
+ * rest, as the driver polls the GPS only as often as the rate needs. The
+ * rate is not saved here, so the GPS returns to the saved one after a
+ * power cycle.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   Epochs, and with them fixes, come once per period.
+ * 
+ * @param period The time between epochs in ms, from GPS_RATE_MIN_PERIOD
+ *               to GPS_RATE_MAX_PERIOD (10 Hz to 1 Hz)
+ * @return 1 if the GPS accepted the rate, 0 otherwise
+ */
+uint8_t gps_set_rate( const uint16_t period );
+
+/**
+ * Tell the GPS driver the time, so it knows when a fix is due
+ * 
+ * Once called, the driver knows when an epoch ends and when the next one
+ * is due, so it should be called regularly from then on.
+ * 
+ * Precondition:
+ *   now comes from a clock that counts milliseconds, and may wrap.
+ * 
+ * Postcondition:
+ *   The port of the GPS is only read if a fix is due, or a reply to a UBX
+ *     message is awaited, whether it is polled or TX-ready rises.
+ * 
+ * @param now The current time in ms
+ * @return 1 if a fix is due, 0 otherwise
+ */
+uint8_t gps_schedule( const uint32_t now );
+
+/* Constellations the GPS can track, besides GPS itself
+ * The M8 tracks at most three at once, so GLONASS and BeiDou exclude each
+ * other. SBAS and QZSS augment GPS, and follow it.
+ */
+#define GPS_GNSS_GPS     0x01
+#define GPS_GNSS_GLONASS 0x02
+#define GPS_GNSS_GALILEO 0x04
+#define GPS_GNSS_BEIDOU  0x08
+
+/**
+ * Select the constellations the GPS tracks
+ * 
+ * More constellations mean more satellites in view, so a fix comes sooner
+ * after the GPS powers up, at the cost of some power while tracking. The
+ * selection is read back first, and only sent if it differs, since the GPS
+ * restarts its receiver to apply it. It is then saved with the rest of the
+ * configuration.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ *   gnss is a combination of GPS_GNSS_*, without both GLONASS and BeiDou.
+ * 
+ * Postcondition:
+ *   If the selection changed, the current fix is lost and reacquired.
+ * 
+ * @param gnss The constellations to track
+ * @return 1 if the GPS tracks them, 0 otherwise
+ */
+uint8_t gps_set_gnss( const uint8_t gnss );
+
+/**
+ * Save the navigation database of the GPS, for gps_restore_aiding
+ * 
+ * The GPS dumps its ephemerides, almanac and other data, which are stored
+ * in program memory. This is best done once the GPS has tracked for a
+ * while, and before it is powered down.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   The last store is replaced only if the dump completed, and is kept
+ *     if it failed.
+ *   The CPU stalls for a few ms for every page of flash erased.
+ * 
+ * @return 1 if the database was stored, 0 otherwise
+ */
+uint8_t gps_save_aiding( void );
+
+/**
+ * Send the navigation database stored by gps_save_aiding back to the GPS
+ * 
+ * Called at startup, this lets a GPS that lost its data make a warm or
+ * hot start rather than a cold one.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   The GPS has the time, if given, and the stored database.
+ * 
+ * @param now The current UTC time and date, or NULL if unknown
+ * @return 1 if a stored database was sent, 0 otherwise
+ */
+uint8_t gps_restore_aiding( const gps_fix_t *now );
+
+/*
+ * Diagnostics of the GPS, for telemetry
+ */
+typedef struct {
+  uint32_t ttff;  // time to first fix since the receiver started, ms, 0 if none yet
+  uint32_t msss;  // time since the receiver started, ms
+  uint8_t  gnss;  // GPS_GNSS_* flags of the constellations tracked
+  uint8_t  numSV; // satellites used in the last fix
+} gps_diagnostics_t;
+
+/**
+ * Read the diagnostics of the GPS
+ * 
+ * The receiver status is polled, and waited for.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   None.
+ * 
+ * @param diagnostics Where the diagnostics will be saved
+ * @return 1 if the GPS answered, 0 otherwise
+ */
+uint8_t gps_get_diagnostics( gps_diagnostics_t *diagnostics );
+
+/**
+ * Read an NMEA sentence from the GPS, without blocking
+ * 
+ * The GPS is read in the background, from the I2C interrupt, into a ring
+ * buffer, whenever the GPS raises its TX-ready pin. This call only takes
+ * the next complete sentence out of the ring, and restarts the background
+ * reads if they have stopped with data still pending.
  * 
  * Precondition:
  *   GPS must be initialized.
  *   buffer must be a valid memory address.
  * 
  * Postcondition:
- *   The next read will continue from the last character read
+ *   A partial sentence is kept, and completed by later calls
  * 
  * @param buffer A pointer to where a message will be saved
  * @param n The maximum number of bytes to read into the buffer
- * @return 1 is the transaction was successful, 0 otherwise
+ * @return 1 if a sentence was saved to buffer, 0 if none is ready yet
  */
 uint8_t gps_get_nmea( char *buffer, const uint8_t n );
 
 /**
- * Validates an NMEA sentence.
+ * Read the next navigation solution from the GPS, without blocking
+ * 
+ * Like gps_get_nmea, this only takes what the background reads have
+ * already brought in. Only the latest solution is kept.
  * 
  * Precondition:
- *   sentence must point to a null-terminated string.
+ *   GPS must be initialized in GPS_MODE_UBX.
  * 
  * Postcondition:
- *   None.
+ *   The same solution is not returned twice.
+ * 
+ * @param solution Where the solution will be saved
+ * @return 1 if a solution was saved, 0 if none is ready yet
+ */
+uint8_t gps_get_pvt( ubx_nav_pvt_t *solution );
+
+/*
+ * The output of a navigation epoch, published as a whole
+ * 
+ * In GPS_MODE_NMEA, gga and rmc are the sentences of the epoch, a length
+ * of 0 meaning the GPS did not output it. fix merges everything up to
+ * the end of the epoch, in either mode.
+ */
+typedef struct {
+  nmea_sentence_t gga;
+  nmea_sentence_t rmc;
+  gps_fix_t       fix;
+  uint32_t        iTOW; // GPS time of week of the epoch, ms
+} gps_epoch_t;
+
+/**
+ * Read the last complete epoch from the GPS, without blocking
+ * 
+ * The GPS marks the end of each epoch with UBX-NAV-EOE. Until it arrives,
+ * the sentences of the epoch are held back, so a GGA is never sent
+ * without the RMC that goes with it.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   The same epoch is not returned twice.
+ * 
+ * @param epoch Where the epoch will be saved
+ * @return 1 if an epoch was saved, 0 if none ended since the last call
+ */
+uint8_t gps_get_epoch( gps_epoch_t *epoch );
+
+/**
+ * Read the current fix from the GPS, without blocking
+ * 
+ * The fix is decoded from GGA and RMC sentences in GPS_MODE_NMEA, or from
+ * the navigation solution in GPS_MODE_UBX. It only holds integers, and is
+ * meant as the basis of compact telemetry in place of the sentence text.
+ * 
+ * Precondition:
+ *   GPS must be initialized.
+ * 
+ * Postcondition:
+ *   The fix is not returned again until another sentence or solution
+ *     updates it.
  * 
- * @param sentence The string to validate.
- * @return 1 if the sentence is valid, 0 otherwise
+ * @param current Where the fix will be saved
+ * @return 1 if the fix was updated and saved, 0 otherwise
  */
-uint8_t nmea_validate( const char *sentence );
+uint8_t gps_get_fix( gps_fix_t *current );
 
 #endif	/* GPS_H */
 
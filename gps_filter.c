@@ -0,0 +1,152 @@
+/* 
+ * File:     gps_filter.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include "gps_filter.h"
+
+// Seconds in a day, where the time of a fix wraps
+#define SECONDS_PER_DAY 86400UL
+
+/**
+ * Absolute difference of two signed values, without overflow
+ * @param a The first value
+ * @param b The second value
+ * @return |a - b|
+ */
+static uint32_t gps_filter_delta( const int32_t a, const int32_t b ) {
+  return ( a > b ) ? (uint32_t)a - (uint32_t)b : (uint32_t)b - (uint32_t)a;
+}
+
+/**
+ * Checks if two fixes are of the same epoch
+ * @param a The first fix
+ * @param b The second fix
+ * @return 1 if both have the same time, 0 otherwise or without a time
+ */
+static uint8_t gps_filter_same_epoch( const gps_fix_t *a, const gps_fix_t *b ) {
+  return ( a->valid & b->valid & FIX_VALID_TIME )
+      && a->time == b->time && a->millis == b->millis;
+}
+
+/**
+ * Checks if maxInterval has passed since the last fix let through
+ * @param filter The filter
+ * @param fix The fix
+ * @return 1 if it has, 0 otherwise or without a time
+ */
+static uint8_t gps_filter_interval_due( const gps_filter_t *filter, const gps_fix_t *fix ) {
+  
+  uint32_t elapsed;
+  
+  if( !filter->config.maxInterval ) return 0;
+  if( !( fix->valid & filter->last.valid & FIX_VALID_TIME ) ) return 0;
+  
+  // the time of day wraps at midnight
+  elapsed = ( fix->time + SECONDS_PER_DAY - filter->last.time ) % SECONDS_PER_DAY;
+  return elapsed >= filter->config.maxInterval;
+}
+
+/**
+ * Checks if a fix moved far enough from the last one let through
+ * @param filter The filter
+ * @param fix The fix, with a position
+ * @return 1 if it did, 0 otherwise
+ */
+static uint8_t gps_filter_moved( const gps_filter_t *filter, const gps_fix_t *fix ) {
+  
+  const gps_fix_t *last = &filter->last;
+  
+  if( !( last->valid & FIX_VALID_POSITION ) ) return 1;
+  
+  if( gps_filter_delta( fix->lat, last->lat ) >= filter->config.minDistance ) return 1;
+  if( gps_filter_delta( fix->lon, last->lon ) >= filter->config.minDistance ) return 1;
+  
+  // gaining or losing the altitude is news too
+  if( ( fix->valid ^ last->valid ) & FIX_VALID_ALTITUDE ) return 1;
+  if( ( fix->valid & FIX_VALID_ALTITUDE )
+      && gps_filter_delta( fix->alt, last->alt ) >= filter->config.minAltitude ) return 1;
+  
+  return 0;
+}
+
+/**
+ * Judges a complete fix
+ * @param filter The filter
+ * @param fix The fix
+ * @param out Where the fix is saved if it is let through
+ * @return 1 if it was let through, 0 otherwise
+ */
+static uint8_t gps_filter_judge( gps_filter_t *filter, const gps_fix_t *fix, gps_fix_t *out ) {
+  
+  gps_filter_counters_t *counters = &filter->counters;
+  
+  if( filter->lastSet ) {
+    
+    if( gps_filter_same_epoch( fix, &filter->last ) ) {
+      counters->duplicate++;
+      return 0;
+    }
+    
+    if( !gps_filter_interval_due( filter, fix ) ) {
+      
+      if( !( fix->valid & FIX_VALID_POSITION ) ) {
+        counters->noFix++;
+        return 0;
+      }
+      
+      if( !gps_filter_moved( filter, fix ) ) {
+        counters->still++;
+        return 0;
+      }
+    }
+  }
+  else if( !( fix->valid & FIX_VALID_POSITION ) ) {
+    counters->noFix++;
+    return 0;
+  }
+  
+  filter->last = *fix;
+  filter->lastSet = 1;
+  *out = *fix;
+  counters->passed++;
+  return 1;
+}
+
+void gps_filter_init( gps_filter_t *filter, const gps_filter_config_t *config ) {
+  
+  filter->config = *config;
+  filter->counters.passed = 0;
+  filter->counters.merged = 0;
+  filter->counters.duplicate = 0;
+  filter->counters.noFix = 0;
+  filter->counters.still = 0;
+  filter->lastSet = 0;
+  filter->heldSet = 0;
+}
+
+uint8_t gps_filter_accept( gps_filter_t *filter, const gps_fix_t *fix, gps_fix_t *out ) {
+  
+  uint8_t passed = 0;
+  
+  if( !filter->config.mergeEpochs ) return gps_filter_judge( filter, fix, out );
+  
+  // a later update of the same epoch replaces the one held
+  if( filter->heldSet && gps_filter_same_epoch( fix, &filter->held ) ) {
+    filter->counters.merged++;
+  }
+  
+  // the epoch held is complete once another one begins
+  else if( filter->heldSet ) {
+    passed = gps_filter_judge( filter, &filter->held, out );
+  }
+  
+  filter->held = *fix;
+  filter->heldSet = 1;
+  return passed;
+}
+
+const gps_filter_counters_t *gps_filter_counters( const gps_filter_t *filter ) {
+  return &filter->counters;
+}
@@ -0,0 +1,111 @@
+/* 
+ * File:     gps_filter.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef GPS_FILTER_H
+#define	GPS_FILTER_H
+
+#include <stdint.h>
+#include "gps_fix.h"
+
+/*
+ * Fixes come from the GPS every navigation epoch, but most of them say
+ * nothing new while the payload sits still, and airtime is scarce. The
+ * filter sits between the GPS and the radio, and only lets a fix through
+ * if it carries new information:
+ * 
+ *   - a fix of the epoch already let through is a duplicate
+ *   - a fix is let through if maxInterval has passed since the last one,
+ *     so the ground still hears from us while nothing changes
+ *   - a fix without a position is dropped
+ *   - a fix is let through if it moved minDistance in latitude or longitude,
+ *     or minAltitude in altitude, from the last one let through
+ *   - anything else is dropped as still
+ * 
+ * In NMEA mode GGA and RMC of an epoch each update the fix, so it arrives
+ * twice, and only complete after the second sentence. With mergeEpochs,
+ * the filter holds each fix until one of a later epoch arrives, merging the
+ * updates of an epoch into the last one, and judges the complete fix then.
+ * This delays every fix by an epoch, so it is not needed with NAV-PVT.
+ */
+
+/*
+ * Thresholds of a filter
+ * 
+ * minDistance is compared to the change of latitude and longitude each,
+ * not a true distance, so it is only exact in latitude. A degree of
+ * longitude shrinks away from the equator, which only makes the filter
+ * let more through.
+ */
+typedef struct {
+  uint32_t minDistance; // 1e-7 deg, about 1.1 cm
+  uint32_t minAltitude; // mm
+  uint32_t maxInterval; // s, 0 to never force a fix through
+  uint8_t  mergeEpochs; // 1 to merge the fixes of an epoch first
+} gps_filter_config_t;
+
+/*
+ * What a filter did with the fixes it was given
+ */
+typedef struct {
+  uint16_t passed;    // let through
+  uint16_t merged;    // merged into a later fix of the same epoch
+  uint16_t duplicate; // of an epoch already let through
+  uint16_t noFix;     // without a position
+  uint16_t still;     // below every threshold
+} gps_filter_counters_t;
+
+/*
+ * The state of a filter. Its fields are private to gps_filter.c.
+ */
+typedef struct {
+  gps_filter_config_t   config;
+  gps_filter_counters_t counters;
+  gps_fix_t             last;
+  uint8_t               lastSet;
+  gps_fix_t             held;
+  uint8_t               heldSet;
+} gps_filter_t;
+
+/**
+ * Initialize a filter
+ * 
+ * Precondition:
+ *   filter and config must be valid memory addresses.
+ * 
+ * Postcondition:
+ *   The first fix with a position will be let through.
+ *   The counters are cleared.
+ * 
+ * @param filter The filter to initialize
+ * @param config The thresholds, which are copied
+ */
+void gps_filter_init( gps_filter_t *filter, const gps_filter_config_t *config );
+
+/**
+ * Give a filter the next fix from the GPS
+ * 
+ * Precondition:
+ *   filter must be initialized.
+ * 
+ * Postcondition:
+ *   The counters account for the fix, or with mergeEpochs, for the one
+ *     held before it.
+ * 
+ * @param filter The filter
+ * @param fix The latest fix
+ * @param out Where a fix that carries new information will be saved
+ * @return 1 if a fix was saved to out and should be sent, 0 otherwise
+ */
+uint8_t gps_filter_accept( gps_filter_t *filter, const gps_fix_t *fix, gps_fix_t *out );
+
+/**
+ * Get the counters of a filter
+ * @param filter The filter
+ * @return What the filter did with the fixes it was given
+ */
+const gps_filter_counters_t *gps_filter_counters( const gps_filter_t *filter );
+
+#endif	/* GPS_FILTER_H */
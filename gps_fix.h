@@ -0,0 +1,45 @@
+/* 
+ * File:     gps_fix.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef GPS_FIX_H
+#define	GPS_FIX_H
+
+#include <stdint.h>
+
+/*
+ * A position fix, decoded from GGA and RMC sentences or from NAV-PVT.
+ * 
+ * Every field is a fixed-point integer, so nothing here ever needs floating
+ * point (XC16 only has it in software, which is both slow and large).
+ * 
+ * GGA and RMC each carry only part of a fix, so they are merged into the
+ * same structure as they arrive. valid tells which parts are current.
+ */
+typedef struct {
+  uint32_t time;     // UTC, seconds of day
+  uint16_t millis;   // UTC, milliseconds within the second
+  uint16_t year;     // UTC date
+  uint8_t  month;
+  uint8_t  day;
+  int32_t  lat;      // 1e-7 deg, north is positive
+  int32_t  lon;      // 1e-7 deg, east is positive
+  int32_t  alt;      // above mean sea level, mm
+  int32_t  speed;    // speed over ground, mm/s
+  uint16_t course;   // course over ground, 0.01 deg
+  uint16_t hdop;     // dilution of precision, 0.01 (PDOP from NAV-PVT)
+  uint8_t  quality;  // 0 no fix, 1 autonomous, 2 differential, 6 estimated
+  uint8_t  numSV;    // satellites used
+  uint8_t  valid;    // FIX_VALID_* flags
+} gps_fix_t;
+
+/* Flags of the parts of a fix that are current */
+#define FIX_VALID_TIME     0x01
+#define FIX_VALID_DATE     0x02
+#define FIX_VALID_POSITION 0x04
+#define FIX_VALID_ALTITUDE 0x08
+#define FIX_VALID_VELOCITY 0x10
+
+#endif	/* GPS_FIX_H */
\ No newline at end of file
@@ -1,38 +1,544 @@
 /* 
  * File:     i2c.c
  * Author:   Christopher Madrigal
- * Modified: 20 February 2020
+ * Modified: 17 October 2026
  */
 
+#include <xc.h>
+#include <string.h>
 #include "mcc_generated_files/i2c2.h"
 #include "i2c.h"
 
-uint8_t I2C_block_read( const uint16_t address, void *data, const uint8_t n ) {
+// SCL2 and SDA2, as port pins while the module is disabled. They are only
+// ever driven low, and left to the pull-ups to go high
+#define I2C_SCL_LOW()     _TRISB3 = 0
+#define I2C_SCL_RELEASE() _TRISB3 = 1
+#define I2C_SDA_LOW()     _TRISB2 = 0
+#define I2C_SDA_RELEASE() _TRISB2 = 1
+#define I2C_SDA_GET()     _RB2
+
+// Clocks that take a slave through the rest of a byte and its acknowledge
+#define I2C_RECOVERY_CLOCKS 9
+
+// Half a clock of the recovery, for 100 kHz
+#define I2C_RECOVERY_HALF_US 5
+
+// Transfers that are not done, newest first, and the time their bytes take
+static I2C_request_t *active = NULL;
+static uint32_t       activeBudget = 0;
+
+static uint8_t lastError = I2C_ERROR_NONE;
+
+// Counts of each slave, and of every slave after the first I2C_STATS_SLAVES
+static I2C_stats_t slaveStats[I2C_STATS_SLAVES + 1];
+static uint8_t     slaveStatsCount = 0;
+
+/**
+ * Sorts a completion code of the driver into an I2C_ERROR_* category
+ * @param status The completion code
+ * @return The category
+ */
+static uint8_t I2C_error_of( const I2C2_MESSAGE_STATUS status ) {
   
-  // Set status as message pending
-  I2C2_MESSAGE_STATUS reqStatus = I2C2_MESSAGE_PENDING;
+  switch( status ) {
+  case I2C2_MESSAGE_COMPLETE:
+    return I2C_ERROR_NONE;
+    
+  case I2C2_MESSAGE_ADDRESS_NO_ACK:
+  case I2C2_DATA_NO_ACK:
+    return I2C_ERROR_NACK;
+    
+  case I2C2_MESSAGE_FAIL:
+  case I2C2_STUCK_START:
+  case I2C2_BUS_COLLISION:
+    return I2C_ERROR_COLLISION;
+    
+  case I2C2_MESSAGE_TIMEOUT:
+    return I2C_ERROR_TIMEOUT;
+    
+  default:
+    return I2C_ERROR_LOST_STATE;
+  }
+}
+
+/**
+ * Finds the counts of a slave, claiming them on its first transfer
+ * 
+ * Precondition:
+ *   The I2C2 interrupt must not run, either because it is masked or
+ *   because this is called from it.
+ * 
+ * @param address The slave
+ * @return Its counts
+ */
+static I2C_stats_t *I2C_stats_of( const uint16_t address ) {
   
-  // Preform read from the address, which updates status
-  I2C2_MasterRead( (uint8_t*)data, n, address, &reqStatus );
+  I2C_stats_t *slave;
+  uint8_t i;
   
-  // We are stuck here (blocked) until status changes
-  while( reqStatus == I2C2_MESSAGE_PENDING ) {}
+  for( i = 0; i < slaveStatsCount && i < I2C_STATS_SLAVES; i++ ) {
+    if( slaveStats[i].address == address ) return &slaveStats[i];
+  }
   
-  // The status may signal error, check for success
-  return ( reqStatus == I2C2_MESSAGE_COMPLETE );
+  // the rest share the last counts once every other one is taken
+  slave = &slaveStats[slaveStatsCount < I2C_STATS_SLAVES ? slaveStatsCount : I2C_STATS_SLAVES];
+  if( slaveStatsCount <= I2C_STATS_SLAVES ) {
+    slave->address = ( slaveStatsCount < I2C_STATS_SLAVES ) ? address : I2C_STATS_OTHER;
+    slaveStatsCount++;
+  }
+  return slave;
+}
+
+/**
+ * Adds one to a count, unless it is full
+ * @param count The count
+ */
+static void I2C_stats_bump( uint16_t *count ) {
+  if( *count != UINT16_MAX ) ( *count )++;
 }
 
-uint8_t I2C_block_write( const uint16_t address, void *data, const uint8_t n ) {
+/**
+ * Counts a list of a transfer that is sent again
+ * @param request The transfer
+ */
+static void I2C_stats_retry( const I2C_request_t *request ) {
   
-  // Set status as message pending
-  I2C2_MESSAGE_STATUS reqStatus = I2C2_MESSAGE_PENDING;
+  uint8_t enabled = IEC3bits.MI2C2IE;
   
-  // Preform write to address, which updates status
-  I2C2_MasterWrite( (uint8_t*)data, n, address, &reqStatus );
+  IEC3bits.MI2C2IE = 0;
+  I2C_stats_bump( &I2C_stats_of( request->address )->retries );
+  IEC3bits.MI2C2IE = enabled;
+}
+
+/**
+ * Counts a transfer as it completes
+ * @param request The transfer
+ * @param error Its I2C_ERROR_* category
+ */
+static void I2C_stats_complete( const I2C_request_t *request, const uint8_t error ) {
   
-  // We are stuck here (blocked) until status changes
-  while( reqStatus == I2C2_MESSAGE_PENDING ) {}
+  uint32_t us = ticks_to_us( ticks_since( request->started ) );
+  uint8_t bucket = 0;
+  I2C_stats_t *slave;
+  uint8_t enabled = IEC3bits.MI2C2IE;
   
-  // The status may signal error, check for success
-  return ( reqStatus == I2C2_MESSAGE_COMPLETE );
-}
\ No newline at end of file
+  while( us > 1 && bucket < I2C_STATS_BUCKETS - 1 ) {
+    us >>= 1;
+    bucket++;
+  }
+  
+  IEC3bits.MI2C2IE = 0;
+  slave = I2C_stats_of( request->address );
+  slave->transactions++;
+  I2C_stats_bump( &slave->latency[bucket] );
+  
+  switch( error ) {
+  case I2C_ERROR_NONE:
+    slave->bytes += request->length;
+    break;
+    
+  case I2C_ERROR_NACK:
+    I2C_stats_bump( &slave->nacks );
+    break;
+    
+  case I2C_ERROR_COLLISION:
+    I2C_stats_bump( &slave->collisions );
+    break;
+    
+  case I2C_ERROR_TIMEOUT:
+    I2C_stats_bump( &slave->timeouts );
+    break;
+  }
+  IEC3bits.MI2C2IE = enabled;
+}
+
+/**
+ * Adds a transfer to the active ones, and sets its deadline
+ * @param request The transfer
+ */
+static void I2C_request_track( I2C_request_t *request ) {
+  
+  uint32_t speed = I2C2_SlaveSpeedGet( request->address );
+  uint8_t enabled;
+  
+  // the bytes run at the speed of the slave. The time of one is found
+  // first, rounded up, as the time of all of them overflows 32 bits
+  request->budget = request->length
+      * ( ( I2C_TIMEOUT_MARGIN * I2C_CLOCKS_PER_BYTE * 1000000UL + speed - 1 ) / speed );
+  
+  enabled = IEC3bits.MI2C2IE;
+  IEC3bits.MI2C2IE = 0;
+  request->nextActive = active;
+  active = request;
+  activeBudget += request->budget;
+  
+  // it may wait for everything still active before it
+  request->started = now_ticks();
+  request->deadline = request->started + ( I2C_TIMEOUT_BASE_US + activeBudget ) * TICKS_PER_US;
+  IEC3bits.MI2C2IE = enabled;
+}
+
+/**
+ * Removes a transfer from the active ones
+ * @param request The transfer
+ */
+static void I2C_request_untrack( I2C_request_t *request ) {
+  
+  I2C_request_t **link;
+  uint8_t enabled = IEC3bits.MI2C2IE;
+  
+  IEC3bits.MI2C2IE = 0;
+  for( link = &active; *link; link = &( *link )->nextActive ) {
+    if( *link == request ) {
+      *link = request->nextActive;
+      activeBudget -= request->budget;
+      break;
+    }
+  }
+  IEC3bits.MI2C2IE = enabled;
+}
+
+/**
+ * Completes a transfer
+ * @param request The transfer
+ * @param error Its I2C_ERROR_* category
+ */
+static void I2C_request_finish( I2C_request_t *request, const uint8_t error ) {
+  
+  I2C_request_untrack( request );
+  I2C_stats_complete( request, error );
+  
+  // the callback may start the request again, so it is let go of first
+  request->error = error;
+  request->success = ( error == I2C_ERROR_NONE );
+  request->done = 1;
+  if( request->callback ) request->callback( request->success, request->context );
+}
+
+/**
+ * Queues the next list of TRBs of a transfer
+ * 
+ * The rest of the transfer is cut into as few TRBs as possible, which are
+ * sent as one list so that the bus is only stopped once per I2C_MAX_TRBS
+ * pieces. The read of a write then read follows its write in the same
+ * list, so the two are joined by a repeated start.
+ * 
+ * @param request The transfer
+ * @return 1 if the list was queued, 0 if the driver queue is full
+ */
+static uint8_t I2C_request_queue( I2C_request_t *request );
+
+/**
+ * Submits the list of TRBs of a transfer that was last built
+ * @param request The transfer
+ * @return 1 if the list was queued, 0 if the driver queue is full
+ */
+static uint8_t I2C_request_submit( I2C_request_t *request );
+
+/**
+ * Continues or completes a transfer
+ * Called from the I2C2 interrupt when a list of TRBs completes
+ * @param status The completion code of the list
+ * @param context The transfer
+ */
+static void I2C_request_next( I2C2_MESSAGE_STATUS status, void *context ) {
+  
+  I2C_request_t *request = (I2C_request_t*)context;
+  uint8_t error = I2C_error_of( status );
+  
+  // a lone TRB whose address was not acknowledged moved nothing, so it is sent again
+  if( status == I2C2_MESSAGE_ADDRESS_NO_ACK && request->count == 1 && request->retries < I2C_RETRIES ) {
+    request->retries++;
+    I2C_stats_retry( request );
+    if( I2C_request_submit( request ) ) return;
+    error = I2C_ERROR_BUSY;
+  }
+  
+  // a long transfer goes on with its next list
+  else if( error == I2C_ERROR_NONE && request->remaining ) {
+    if( I2C_request_queue( request ) ) return;
+    error = I2C_ERROR_BUSY;
+  }
+  
+  I2C_request_finish( request, error );
+}
+
+static uint8_t I2C_request_submit( I2C_request_t *request ) {
+  
+  // Submit the whole list, which updates status
+  I2C2_MasterTRBInsertCallback( request->count, request->trbs, &request->status, I2C_request_next, request );
+  return request->status != I2C2_MESSAGE_FAIL;
+}
+
+static uint8_t I2C_request_queue( I2C_request_t *request ) {
+  
+  uint8_t count = 0;
+  
+  // A write always sends at least the address, even with no data
+  do {
+    uint8_t len = ( request->remaining > I2C_MAX_TRB_LENGTH ) ? I2C_MAX_TRB_LENGTH : (uint8_t)request->remaining;
+    
+    if( request->read ) I2C2_MasterReadTRBBuild( &request->trbs[count], request->data, len, request->address );
+    else                I2C2_MasterWriteTRBBuild( &request->trbs[count], request->data, len, request->address );
+    
+    request->data += len;
+    request->remaining -= len;
+    count++;
+    
+    // the write of a write then read is followed by its read
+    if( !request->remaining && request->then ) {
+      request->data = request->then;
+      request->remaining = request->thenLength;
+      request->read = 1;
+      request->then = NULL;
+    }
+  } while( request->remaining && count < I2C_MAX_TRBS );
+  
+  request->count = count;
+  request->retries = 0;
+  return I2C_request_submit( request );
+}
+
+/**
+ * Sets up a transfer of any length to or from an I2C Slave
+ * @param request Where the transfer is kept while it runs
+ * @param address The I2C address of the slave
+ * @param data The buffer
+ * @param n The number of bytes to transfer
+ * @param read 1 to read from the slave, 0 to write to it
+ * @param callback Called on completion, or NULL
+ * @param context Passed back to callback
+ */
+static void I2C_request_init( I2C_request_t *request, const uint16_t address, uint8_t *data, const uint16_t n,
+    const uint8_t read, I2C_callback_t callback, void *context ) {
+  
+  request->callback = callback;
+  request->context = context;
+  request->address = address;
+  request->data = data;
+  request->remaining = n;
+  request->read = read;
+  request->then = NULL;
+  request->thenLength = 0;
+  request->length = n;
+  request->success = 0;
+  request->error = I2C_ERROR_NONE;
+  request->done = 0;
+}
+
+/**
+ * Queues the first list of a transfer that was set up
+ * @param request The transfer
+ * @return 1 if the transfer was queued, 0 otherwise
+ */
+static uint8_t I2C_request_begin( I2C_request_t *request ) {
+  
+  I2C_request_track( request );
+  if( I2C_request_queue( request ) ) return 1;
+  
+  I2C_request_untrack( request );
+  request->error = I2C_ERROR_BUSY;
+  return 0;
+}
+
+/**
+ * Starts a transfer of any length to or from an I2C Slave
+ * @param request Where the transfer is kept while it runs
+ * @param address The I2C address of the slave
+ * @param data The buffer
+ * @param n The number of bytes to transfer
+ * @param read 1 to read from the slave, 0 to write to it
+ * @param callback Called on completion, or NULL
+ * @param context Passed back to callback
+ * @return 1 if the transfer was queued, 0 otherwise
+ */
+static uint8_t I2C_request_start( I2C_request_t *request, const uint16_t address, uint8_t *data, const uint16_t n,
+    const uint8_t read, I2C_callback_t callback, void *context ) {
+  
+  I2C_request_init( request, address, data, n, read, callback, context );
+  return I2C_request_begin( request );
+}
+
+/**
+ * Waits for a transfer to be done
+ * @param request The transfer, which must have been queued
+ * @return 1 if the transaction was successful, 0 otherwise
+ */
+static uint8_t I2C_request_wait( I2C_request_t *request ) {
+  
+  // We are stuck here (blocked) until the whole transfer is done, which
+  // its deadline bounds
+  while( !request->done ) I2C_service();
+  
+  lastError = request->error;
+  return request->success;
+}
+
+/**
+ * Preforms a blocking transfer of any length to or from an I2C Slave
+ * @param address The I2C address of the slave
+ * @param data The buffer
+ * @param n The number of bytes to transfer
+ * @param read 1 to read from the slave, 0 to write to it
+ * @return 1 if the transaction was successful, 0 otherwise
+ */
+static uint8_t I2C_block_transfer( const uint16_t address, uint8_t *data, uint16_t n, const uint8_t read ) {
+  
+  I2C_request_t request;
+  
+  if( !I2C_request_start( &request, address, data, n, read, NULL, NULL ) ) {
+    lastError = request.error;
+    return 0;
+  }
+  return I2C_request_wait( &request );
+}
+
+uint8_t I2C_block_read( const uint16_t address, void *data, const uint16_t n ) {
+  
+  // The driver cannot receive an empty message
+  if( !n ) {
+    lastError = I2C_ERROR_NONE;
+    return 1;
+  }
+  
+  return I2C_block_transfer( address, (uint8_t*)data, n, 1 );
+}
+
+uint8_t I2C_block_write( const uint16_t address, void *data, const uint16_t n ) {
+  return I2C_block_transfer( address, (uint8_t*)data, n, 0 );
+}
+
+uint8_t I2C_read_async( I2C_request_t *request, const uint16_t address, void *data, const uint16_t n,
+    I2C_callback_t callback, void *context ) {
+  
+  // The driver cannot receive an empty message
+  if( !n ) {
+    request->success = 1;
+    request->error = I2C_ERROR_NONE;
+    request->done = 1;
+    if( callback ) callback( 1, context );
+    return 1;
+  }
+  
+  return I2C_request_start( request, address, (uint8_t*)data, n, 1, callback, context );
+}
+
+uint8_t I2C_write_async( I2C_request_t *request, const uint16_t address, void *data, const uint16_t n,
+    I2C_callback_t callback, void *context ) {
+  return I2C_request_start( request, address, (uint8_t*)data, n, 0, callback, context );
+}
+
+uint8_t I2C_write_read_async( I2C_request_t *request, const uint16_t address, void *out, const uint16_t nOut,
+    void *in, const uint16_t nIn, I2C_callback_t callback, void *context ) {
+  
+  // The driver cannot receive an empty message, so this is only a write
+  if( !nIn ) return I2C_write_async( request, address, out, nOut, callback, context );
+  
+  I2C_request_init( request, address, (uint8_t*)out, nOut, 0, callback, context );
+  request->then = (uint8_t*)in;
+  request->thenLength = nIn;
+  request->length += nIn;
+  
+  return I2C_request_begin( request );
+}
+
+uint8_t I2C_write_read( const uint16_t address, void *out, const uint16_t nOut, void *in, const uint16_t nIn ) {
+  
+  I2C_request_t request;
+  
+  if( !I2C_write_read_async( &request, address, out, nOut, in, nIn, NULL, NULL ) ) {
+    lastError = request.error;
+    return 0;
+  }
+  return I2C_request_wait( &request );
+}
+
+/**
+ * Waits half a clock of the recovery
+ */
+static void I2C_recovery_wait( void ) {
+  ticks_t start = now_ticks();
+  while( ticks_since( start ) < I2C_RECOVERY_HALF_US * TICKS_PER_US ) {}
+}
+
+/**
+ * Fails every transfer, frees a stuck bus, and starts over
+ */
+static void I2C_recover( void ) {
+  
+  uint8_t i;
+  
+  // every transfer fails, and SCL and SDA become port pins
+  I2C2_MasterAbort( I2C2_MESSAGE_TIMEOUT );
+  
+  _LATB3 = 0;
+  _LATB2 = 0;
+  I2C_SDA_RELEASE();
+  
+  // a slave stuck in the middle of a byte holds SDA low, until it has been
+  // clocked through the rest of it
+  for( i = 0; i < I2C_RECOVERY_CLOCKS && !I2C_SDA_GET(); i++ ) {
+    I2C_SCL_LOW();
+    I2C_recovery_wait();
+    I2C_SCL_RELEASE();
+    I2C_recovery_wait();
+  }
+  
+  // then a stop condition leaves every slave idle
+  I2C_SCL_LOW();
+  I2C_recovery_wait();
+  I2C_SDA_LOW();
+  I2C_recovery_wait();
+  I2C_SCL_RELEASE();
+  I2C_recovery_wait();
+  I2C_SDA_RELEASE();
+  I2C_recovery_wait();
+  
+  I2C2_MasterResume();
+}
+
+uint8_t I2C_service( void ) {
+  
+  I2C_request_t *request;
+  uint8_t expired = 0;
+  ticks_t now = now_ticks();
+  uint8_t enabled = IEC3bits.MI2C2IE;
+  
+  IEC3bits.MI2C2IE = 0;
+  for( request = active; request; request = request->nextActive ) {
+    if( (int32_t)( now - request->deadline ) >= 0 ) expired = 1;
+  }
+  IEC3bits.MI2C2IE = enabled;
+  
+  if( !expired ) return 0;
+  
+  I2C_recover();
+  return 1;
+}
+
+uint8_t I2C_last_error( void ) {
+  return lastError;
+}
+
+uint8_t I2C_stats_get( const uint8_t index, I2C_stats_t *stats ) {
+  
+  uint8_t found;
+  uint8_t enabled = IEC3bits.MI2C2IE;
+  
+  IEC3bits.MI2C2IE = 0;
+  found = ( index < slaveStatsCount );
+  if( found ) *stats = slaveStats[index];
+  IEC3bits.MI2C2IE = enabled;
+  
+  return found;
+}
+
+void I2C_stats_reset( void ) {
+  
+  uint8_t enabled = IEC3bits.MI2C2IE;
+  
+  IEC3bits.MI2C2IE = 0;
+  memset( slaveStats, 0, sizeof( slaveStats ) );
+  slaveStatsCount = 0;
+  IEC3bits.MI2C2IE = enabled;
+}
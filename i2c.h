@@ -1,33 +1,296 @@
 /* 
  * File:     i2c.h
  * Author:   Christopher Madrigal
- * Modified: 20 February 2020
+ * Modified: 17 October 2026
  */
 
 #ifndef I2C_H
 #define	I2C_H
 
 #include <stdint.h>
+#include "mcc_generated_files/i2c2.h"
+#include "ticks.h"
+
+/*
+ * Every transfer has a deadline, set when it starts, long enough for it
+ * and everything already queued ahead of it to move each of their bytes
+ * I2C_TIMEOUT_MARGIN times over at the speed of their slave, on top of
+ * I2C_TIMEOUT_BASE_US. I2C_service checks them, and
+ * once one passes, the bus is taken to be stuck:
+ * 
+ *   - the I2C2 module is disabled, and every transfer fails as a timeout
+ *   - SCL is clocked up to 9 times, until a slave stuck in the middle of
+ *     a byte lets go of SDA, and a stop condition is sent
+ *   - the module is enabled again, and starts what was queued since
+ * 
+ * Blocking transfers call I2C_service while they wait, so none of them
+ * can stall the system for longer than its own deadline, plus the tens of
+ * microseconds of the recovery.
+ * 
+ * A list of a single TRB whose address is not acknowledged moved no data,
+ * so it is sent again, up to I2C_RETRIES times, before the transfer fails.
+ * The driver only tells these apart from other NACKs for reads, which are
+ * the lists the GPS answers with a NACK while it is busy.
+ * 
+ * Every transfer is counted against its slave as it completes, which is
+ * in the I2C2 interrupt unless it timed out. Its latency runs from when
+ * it was started to then, so it includes the time it waited in the queue.
+ * I2C_stats_get reads the counts of each slave for housekeeping.
+ */
+
+/* Why a transfer failed */
+#define I2C_ERROR_NONE       0
+#define I2C_ERROR_NACK       1 // the slave did not acknowledge its address or a byte
+#define I2C_ERROR_COLLISION  2 // the bus was taken from us, or a write collided
+#define I2C_ERROR_TIMEOUT    3 // the deadline passed, and the bus was recovered
+#define I2C_ERROR_LOST_STATE 4 // the driver lost track of the transfer
+#define I2C_ERROR_BUSY       5 // the driver queue was full
+
+// A byte and its acknowledge are 9 clocks
+#define I2C_CLOCKS_PER_BYTE 9UL
+
+// How many times over the bytes of a transfer may take
+#define I2C_TIMEOUT_MARGIN 2UL
+
+// Time for starting, stopping, and slaves stretching the clock
+#define I2C_TIMEOUT_BASE_US 20000UL
+
+// Times a list whose address was not acknowledged is sent again
+#define I2C_RETRIES 2
+
+// Slaves counted apart; any more are counted together, as I2C_STATS_OTHER
+#define I2C_STATS_SLAVES 4
+#define I2C_STATS_OTHER  0xFFFF
+
+// Bucket i of a latency histogram counts latencies of 2^i us up to
+// 2^(i + 1) us, except that the first also counts 0 us and the last counts
+// everything longer
+#define I2C_STATS_BUCKETS 16
+
+// A TRB stores its length in 8 bits, so this is the most one TRB can move
+#define I2C_MAX_TRB_LENGTH 255
+
+// The most TRBs submitted to the driver as a single list
+#define I2C_MAX_TRBS 8
+
+/**
+ * Called once an asynchronous transfer completes
+ * 
+ * It is called from the I2C2 interrupt, or from I2C_service if the bus is
+ * recovered, so it must be short. It may start another transfer,
+ * including one on the same request.
+ * 
+ * @param success 1 if the transfer was successful, 0 otherwise
+ * @param context The context given when the transfer was started
+ */
+typedef void (*I2C_callback_t)( uint8_t success, void *context );
+
+/*
+ * An asynchronous transfer, owned by the caller
+ * 
+ * It must stay in place, and must not be started again, until done is set.
+ * Its fields are private to i2c.c, except done, success and error, which
+ * may be polled in place of a callback.
+ */
+typedef struct I2C_request_s {
+  I2C2_TRANSACTION_REQUEST_BLOCK trbs[I2C_MAX_TRBS];
+  I2C2_MESSAGE_STATUS status;
+  I2C_callback_t      callback;
+  void               *context;
+  uint16_t            address;
+  uint8_t            *data;
+  uint16_t            remaining;
+  uint8_t             read;
+  uint8_t            *then;
+  uint16_t            thenLength;
+  uint16_t            length;
+  uint32_t            budget;
+  uint8_t             count;
+  uint8_t             retries;
+  ticks_t             started;
+  ticks_t             deadline;
+  struct I2C_request_s *nextActive;
+  volatile uint8_t    success;
+  volatile uint8_t    error;
+  volatile uint8_t    done;
+} I2C_request_t;
+
+/*
+ * The counts of one slave, since startup or I2C_stats_reset
+ */
+typedef struct {
+  uint16_t address;      // the slave, or I2C_STATS_OTHER
+  uint32_t transactions; // transfers completed, successful or not
+  uint32_t bytes;        // bytes moved by successful transfers
+  uint16_t nacks;
+  uint16_t collisions;
+  uint16_t timeouts;
+  uint16_t retries;      // lists sent again, see I2C_RETRIES
+  uint16_t latency[I2C_STATS_BUCKETS];
+} I2C_stats_t;
 
 /**
  * Preforms a blocking write to an I2C Slave
  * 
+ * Transfers longer than a single TRB can describe are split into several
+ * TRBs, chained by repeated starts, and submitted together.
+ * 
+ * The CPU does nothing else while it waits, so this is meant for
+ * initialization; elsewhere, prefer I2C_write_async.
+ * 
  * @param address The I2C address of the slave
  * @param data The buffer 
- * @param n The maximum bytes to be read into data
+ * @param n The number of bytes to write from data
  * @return 1 if the transaction was successful, 0 otherwise
  */
-uint8_t I2C_block_write( const uint16_t address, void *data, const uint8_t n );
+uint8_t I2C_block_write( const uint16_t address, void *data, const uint16_t n );
 
 /**
  * Preforms a blocking read from an I2C Slave
  * 
+ * Transfers longer than a single TRB can describe are split into several
+ * TRBs, chained by repeated starts, and submitted together.
+ * 
+ * The CPU does nothing else while it waits, so this is meant for
+ * initialization; elsewhere, prefer I2C_read_async.
+ * 
  * @param address The I2C address of the slave
  * @param data The buffer 
  * @param n The maximum bytes to be read into data
  * @return 1 if the transaction was successful, 0 otherwise
  */
-uint8_t I2C_block_read( const uint16_t address, void *data, const uint8_t n );
+uint8_t I2C_block_read( const uint16_t address, void *data, const uint16_t n );
+
+/**
+ * Preforms a blocking write then read to an I2C Slave, such as setting a
+ * register pointer then reading the register
+ * 
+ * The write and the read are submitted as one list of TRBs, so they are
+ * joined by a repeated start instead of a stop and a start, and nothing
+ * else can take the bus between them.
+ * 
+ * @param address The I2C address of the slave
+ * @param out The buffer to write
+ * @param nOut The number of bytes to write from out
+ * @param in The buffer to read into
+ * @param nIn The number of bytes to read into in
+ * @return 1 if the transaction was successful, 0 otherwise
+ */
+uint8_t I2C_write_read( const uint16_t address, void *out, const uint16_t nOut, void *in, const uint16_t nIn );
+
+/**
+ * Starts a write to an I2C Slave, and returns at once
+ * 
+ * Transfers longer than I2C_MAX_TRBS TRBs are queued a list at a time,
+ * each from the completion of the one before.
+ * 
+ * Precondition:
+ *   request is not in use by an earlier transfer that is not done.
+ *   data stays valid until the transfer is done.
+ * 
+ * Postcondition:
+ *   If the transfer was queued, request->done is set and callback is
+ *     called once it completes.
+ * 
+ * @param request Where the transfer is kept while it runs
+ * @param address The I2C address of the slave
+ * @param data The buffer
+ * @param n The number of bytes to write from data
+ * @param callback Called on completion, or NULL to poll request->done
+ * @param context Passed back to callback
+ * @return 1 if the transfer was queued, 0 if the driver queue is full
+ */
+uint8_t I2C_write_async( I2C_request_t *request, const uint16_t address, void *data, const uint16_t n,
+    I2C_callback_t callback, void *context );
+
+/**
+ * Starts a read from an I2C Slave, and returns at once
+ * 
+ * Transfers longer than I2C_MAX_TRBS TRBs are queued a list at a time,
+ * each from the completion of the one before. A read of no bytes is done
+ * at once, and calls callback before returning.
+ * 
+ * Precondition:
+ *   request is not in use by an earlier transfer that is not done.
+ *   data stays valid until the transfer is done.
+ * 
+ * Postcondition:
+ *   If the transfer was queued, request->done is set and callback is
+ *     called once it completes.
+ * 
+ * @param request Where the transfer is kept while it runs
+ * @param address The I2C address of the slave
+ * @param data The buffer
+ * @param n The number of bytes to read into data
+ * @param callback Called on completion, or NULL to poll request->done
+ * @param context Passed back to callback
+ * @return 1 if the transfer was queued, 0 if the driver queue is full
+ */
+uint8_t I2C_read_async( I2C_request_t *request, const uint16_t address, void *data, const uint16_t n,
+    I2C_callback_t callback, void *context );
+
+/**
+ * Starts a write then read to an I2C Slave, joined by a repeated start,
+ * and returns at once
+ * 
+ * Precondition:
+ *   request is not in use by an earlier transfer that is not done.
+ *   out and in stay valid until the transfer is done.
+ * 
+ * Postcondition:
+ *   If the transfer was queued, request->done is set and callback is
+ *     called once it completes.
+ * 
+ * @param request Where the transfer is kept while it runs
+ * @param address The I2C address of the slave
+ * @param out The buffer to write
+ * @param nOut The number of bytes to write from out
+ * @param in The buffer to read into
+ * @param nIn The number of bytes to read into in
+ * @param callback Called on completion, or NULL to poll request->done
+ * @param context Passed back to callback
+ * @return 1 if the transfer was queued, 0 if the driver queue is full
+ */
+uint8_t I2C_write_read_async( I2C_request_t *request, const uint16_t address, void *out, const uint16_t nOut,
+    void *in, const uint16_t nIn, I2C_callback_t callback, void *context );
+
+/**
+ * Enforces the deadlines of transfers
+ * 
+ * Meant to be called regularly from the main loop, so asynchronous
+ * transfers cannot stall the bus for good. Blocking transfers call it
+ * themselves while they wait.
+ * 
+ * Postcondition:
+ *   If a deadline has passed, every transfer has failed with
+ *     I2C_ERROR_TIMEOUT, and the bus has been recovered.
+ * 
+ * @return 1 if the bus was recovered, 0 otherwise
+ */
+uint8_t I2C_service( void );
+
+/**
+ * Gets why the last blocking transfer failed
+ * @return An I2C_ERROR_* category, I2C_ERROR_NONE if it did not
+ */
+uint8_t I2C_last_error( void );
+
+/**
+ * Reads the counts of a slave
+ * 
+ * Slaves are numbered in the order of their first transfer, so calling
+ * this with index from 0 until it returns 0 reads every one of them.
+ * 
+ * @param index Which slave
+ * @param stats Where a copy of its counts will be saved
+ * @return 1 if a slave has been counted at index, 0 otherwise
+ */
+uint8_t I2C_stats_get( const uint8_t index, I2C_stats_t *stats );
+
+/**
+ * Clears the counts of every slave
+ */
+void I2C_stats_reset( void );
 
 #endif	/* I2C_H */
 
@@ -0,0 +1,242 @@
+/**
+  EXT_INT Generated Driver API Header File
+
+  @Company:
+    Microchip Technology Inc.
+
+  @File Name:
+    ext_int.h
+
+  @Summary:
+    This is the generated header file for the EXT_INT driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description:
+    This header file provides APIs for driver for EXT_INT.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+#ifndef _EXT_INT_H
+#define _EXT_INT_H
+
+/**
+    Section: Includes
+*/
+#include <xc.h>
+
+/**
+    Section: Macros
+*/
+/**
+  @Summary
+    Clears the interrupt flag for INT1
+
+  @Description
+    This routine clears the interrupt flag for the external interrupt, INT1.
+
+  @Preconditions
+    None.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    void __attribute__ ( ( interrupt, no_auto_psv ) ) _INT1Interrupt(void)
+    {
+        // User Area Begin->code: External Interrupt 1
+
+        // User Area End->code: External Interrupt 1
+        EX_INT1_InterruptFlagClear();
+    }
+    </code>
+
+*/
+#define EX_INT1_InterruptFlagClear()       (IFS1bits.INT1IF = 0)
+/**
+  @Summary
+    Clears the interrupt enable for INT1
+
+  @Description
+    This routine clears the interrupt enable for the external interrupt, INT1.
+    After calling this routine, external interrupts on this pin will not be
+    serviced by the interrupt handler, _INT1Interrupt.
+
+  @Preconditions
+    None.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    // Disable the external interrupt
+    EX_INT1_InterruptDisable();
+    </code>
+
+*/
+#define EX_INT1_InterruptDisable()     (IEC1bits.INT1IE = 0)
+/**
+  @Summary
+    Sets the interrupt enable for INT1
+
+  @Description
+    This routine sets the interrupt enable for the external interrupt, INT1.
+    After calling this routine, external interrupts on this pin will be
+    serviced by the interrupt handler, _INT1Interrupt.
+
+  @Preconditions
+    None.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    // Enable the external interrupt
+    EX_INT1_InterruptEnable();
+    </code>
+
+*/
+#define EX_INT1_InterruptEnable()       (IEC1bits.INT1IE = 1)
+/**
+  @Summary
+    Sets the edge detect of the external interrupt to negative edge.
+
+  @Description
+    This routine set the edge detect of the extern interrupt to negative
+    edge. After this routine is called the interrupt flag will be set when
+    the external interrupt pins level transitions from a high to low level.
+
+  @Preconditions
+    None.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    // Set the edge of external interrupt to negative edge
+    EX_INT1_NegativeEdgeSet();
+    </code>
+
+*/
+#define EX_INT1_NegativeEdgeSet()          (INTCON2bits.INT1EP = 1)
+/**
+  @Summary
+    Sets the edge detect of the external interrupt to positive edge.
+
+  @Description
+    This routine set the edge detect of the extern interrupt to positive
+    edge. After this routine is called the interrupt flag will be set when
+    the external interrupt pins level transitions from a low to high level.
+
+  @Preconditions
+    None.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    // Set the edge of external interrupt to positive edge
+    EX_INT1_PositiveEdgeSet();
+    </code>
+
+*/
+#define EX_INT1_PositiveEdgeSet()          (INTCON2bits.INT1EP = 0)
+
+/**
+    Section: External Interrupt Initializers
+*/
+/**
+  @Summary
+    Initializes the external interrupt pins
+
+  @Description
+    This routine initializes the EXT_INT driver to detect the configured edge,
+    clear the interrupt flag and enable the interrupt for INT1.
+
+  @Preconditions
+    The PPS must map INT1 to a pin configured as a digital input.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+
+  @Example
+    <code>
+    void SYSTEM_Initialize(void)
+    {
+        // Other initializers are called from this function
+        EXT_INT_Initialize ();
+    }
+    </code>
+
+*/
+void EXT_INT_Initialize(void);
+
+/**
+  @Summary
+    Callback for INT1
+
+  @Description
+    This routine is called from the INT1 interrupt handler on every detected
+    edge. The default implementation is empty and weakly linked; define it
+    elsewhere to handle the interrupt.
+
+  @Preconditions
+    EXT_INT_Initialize must have been called.
+
+  @Returns
+    None.
+
+  @Param
+    None.
+*/
+void EX_INT1_CallBack(void);
+
+#endif
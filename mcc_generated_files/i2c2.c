@@ -45,6 +45,7 @@
 */
 
 #include "i2c2.h"
+#include "clock.h"
 
 /**
  Section: Data Types
@@ -89,8 +90,28 @@ typedef struct
     I2C2_MESSAGE_STATUS             *pTrFlag;       // set with the error of the last trb sent.
                                                     // if all trb's are sent successfully,
                                                     // then this is I2C2_MESSAGE_COMPLETE
+    I2C2_CALLBACK                   callback;       // called once pTrFlag holds the final status
+    void                            *context;       // passed back to the callback
 } I2C_TR_QUEUE_ENTRY;
 
+/**
+  I2C Speed Profile Type
+
+  @Summary
+    Defines the bus speed used for one slave.
+
+  @Description
+    This defines the baud rate generator value used for every list whose
+    first TRB is addressed to the slave.
+ */
+typedef struct
+{
+    uint16_t                        address;        // 7 or 10 bit address of the slave
+    uint16_t                        brg;            // I2CxBRG to use with it
+    bool                            disslw;         // I2CxCONL.DISSLW to use with it
+    uint32_t                        frequency;      // SCL frequency that brg achieves, in Hz
+} I2C_SPEED_PROFILE;
+
 /**
   I2C Master Driver Object Type
 
@@ -149,10 +170,21 @@ typedef enum
 
 /* defined for I2C2 */
 
+// one TRB for every entry of the queue, and one for the list on the bus
+#define I2C2_TRB_POOL_LENGTH                    (I2C2_CONFIG_TR_QUEUE_LENGTH + 1)
+
+// I2CxBRG must not be set below 2
+#define I2C2_BRG_MIN                            2
 
-#ifndef I2C2_CONFIG_TR_QUEUE_LENGTH
-        #define I2C2_CONFIG_TR_QUEUE_LENGTH 1
-#endif
+// the pulse gobbler delay, in ns, added to every clock
+#define I2C2_PGD_NS                             130UL
+
+// an acknowledge takes a clock, 2 * (I2CxBRG + 2) instruction cycles, so up
+// to this I2CxBRG it is over sooner than an interrupt could be taken for it
+#define I2C2_ACK_WAIT_BRG_MAX                   14
+
+// how long to wait for an acknowledge that the slave stretches, in loops
+#define I2C2_ACK_WAIT_LOOPS                     16
 
 #define I2C2_TRANSMIT_REG                       I2C2TRN			// Defines the transmit register used to send data.
 #define I2C2_RECEIVE_REG                        I2C2RCV	// Defines the receive register used to receive data.
@@ -174,7 +206,19 @@ typedef enum
 */
 
 static void I2C2_FunctionComplete(void);
+static void I2C2_ModuleEnable(void);
 static void I2C2_Stop(I2C2_MESSAGE_STATUS completion_code);
+static void I2C2_Fail(I2C2_MESSAGE_STATUS completion_code);
+static void I2C2_QueueAdvance(void);
+static uint32_t I2C2_ProfileCompute(I2C_SPEED_PROFILE *pprofile, uint32_t frequency);
+static uint32_t I2C2_BaudRateFrequency(uint16_t brg);
+static I2C_SPEED_PROFILE *I2C2_ProfileFind(uint16_t address);
+static void I2C2_MasterPoolInsert(
+                                uint8_t *pdata,
+                                uint8_t length,
+                                uint16_t address,
+                                bool read,
+                                I2C2_MESSAGE_STATUS *pstatus);
 
 /**
  Section: Local Variables
@@ -187,6 +231,17 @@ static uint8_t                       i2c2_trb_count;
 
 static I2C2_TRANSACTION_REQUEST_BLOCK *p_i2c2_trb_current;
 static I2C_TR_QUEUE_ENTRY            *p_i2c2_current = NULL;
+static I2C_TR_QUEUE_ENTRY            i2c2_current_entry;
+
+// TRBs built by I2C2_MasterWrite and I2C2_MasterRead. They are taken in
+// turn, and the queue runs in order, so the next one is always free
+static I2C2_TRANSACTION_REQUEST_BLOCK i2c2_trb_pool[I2C2_TRB_POOL_LENGTH];
+static uint8_t                       i2c2_trb_pool_next = 0;
+
+// Speed of every slave without a profile of its own, and the profiles
+static I2C_SPEED_PROFILE             i2c2_bus_profile;
+static I2C_SPEED_PROFILE             i2c2_profiles[I2C2_CONFIG_SPEED_PROFILES];
+static uint8_t                       i2c2_profile_count = 0;
 
 
 /**
@@ -204,12 +259,9 @@ void I2C2_Initialize(void)
     i2c2_object.i2cErrors = 0;
     
     // initialize the hardware
-    // Baud Rate Generator Value: I2CBRG 102;   
-    I2C2BRG = 0x66;
-    // ACKEN disabled; STRICT disabled; STREN disabled; GCEN disabled; SMEN disabled; DISSLW enabled; I2CSIDL disabled; ACKDT Sends ACK; SCLREL Holds; RSEN disabled; A10M 7 Bit; PEN disabled; RCEN disabled; SEN disabled; I2CEN enabled; 
-    I2C2CONL = 0x8000;
-    // BCL disabled; D_nA disabled; R_nW disabled; P disabled; S disabled; I2COV disabled; IWCOL disabled; 
-    I2C2STAT = 0x00;
+    // Baud Rate Generator Value: derived from Fcy for I2C2_CONFIG_BUS_SPEED
+    I2C2_ProfileCompute(&i2c2_bus_profile, I2C2_CONFIG_BUS_SPEED);
+    I2C2_ModuleEnable();
 
     /* MI2C2 - I2C2 Master Events */
     // clear the master interrupt flag
@@ -235,21 +287,28 @@ void __attribute__ ( ( interrupt, no_auto_psv ) ) _MI2C2Interrupt ( void )
     static uint16_t i2c_address;
     static uint8_t  i2c_bytes_left;
     static uint8_t  i2c_10bit_address_restart = 0;
+    I2C_SPEED_PROFILE *pprofile;
+    uint8_t         ack_wait;
 
     IFS3bits.MI2C2IF = 0;
             
-    // Check first if there was a collision.
+    // Check first if there was a bus collision, where SDA was found low
+    // while we drove it high. The module has already let go of the bus
+    if(I2C2STATbits.BCL)
+    {
+        I2C2STATbits.BCL = 0;
+        i2c2_object.i2cErrors++;
+        I2C2_Fail(I2C2_BUS_COLLISION);
+        return;
+    }
+
+    // Check if there was a collision.
     // If we have a Write Collision, reset and go to idle state */
     if(I2C2_WRITE_COLLISION_STATUS_BIT)
     {
         // clear the Write colision
         I2C2_WRITE_COLLISION_STATUS_BIT = 0;
-        i2c2_state = S_MASTER_IDLE;
-        *(p_i2c2_current->pTrFlag) = I2C2_MESSAGE_FAIL;
-
-        // reset the buffer pointer
-        p_i2c2_current = NULL;
-
+        I2C2_Fail(I2C2_MESSAGE_FAIL);
         return;
     }
 
@@ -258,31 +317,36 @@ void __attribute__ ( ( interrupt, no_auto_psv ) ) _MI2C2Interrupt ( void )
     {
         case S_MASTER_IDLE:    /* In reset state, waiting for data to send */
 
-            if(i2c2_object.trStatus.s.empty != true)
+            // a stop still on the bus raises the interrupt again once it
+            // is over, and nothing can start before then
+            if(I2C2_STOP_CONDITION_ENABLE_BIT)
             {
-                // grab the item pointed by the head
-                p_i2c2_current     = i2c2_object.pTrHead;
-                i2c2_trb_count     = i2c2_object.pTrHead->count;
-                p_i2c2_trb_current = i2c2_object.pTrHead->ptrb_list;
-
-                i2c2_object.pTrHead++;
-
-                // check if the end of the array is reached
-                if(i2c2_object.pTrHead == (i2c2_tr_queue + I2C2_CONFIG_TR_QUEUE_LENGTH))
-                {
-                    // adjust to restart at the beginning of the array
-                    i2c2_object.pTrHead = i2c2_tr_queue;
-                }
-
-                // since we moved one item to be processed, we know
-                // it is not full, so set the full status to false
-                i2c2_object.trStatus.s.full = false;
+                break;
+            }
 
-                // check if the queue is empty
-                if(i2c2_object.pTrHead == i2c2_object.pTrTail)
+            // let the owner of the bus queue more, which raises the
+            // interrupt again to start it
+            if(i2c2_object.trStatus.s.empty == true)
+            {
+                I2C2_MasterIdleCallBack();
+            }
+            else
+            {
+                // grab a copy of the item pointed by the head, as its
+                // slot can be reused by an insert once the head moves on
+                i2c2_current_entry = *i2c2_object.pTrHead;
+                p_i2c2_current     = &i2c2_current_entry;
+                i2c2_trb_count     = p_i2c2_current->count;
+                p_i2c2_trb_current = p_i2c2_current->ptrb_list;
+
+                I2C2_QueueAdvance();
+
+                // the bus is idle, so the clock can change for this slave
+                pprofile = I2C2_ProfileFind(p_i2c2_trb_current->address >> 1);
+                if (I2C2BRG != pprofile->brg)
                 {
-                    // it is empty so set the empty status to true
-                    i2c2_object.trStatus.s.empty = true;
+                    I2C2BRG = pprofile->brg;
+                    I2C2CONLbits.DISSLW = pprofile->disslw;
                 }
 
                 // send the start condition
@@ -517,8 +581,35 @@ void __attribute__ ( ( interrupt, no_auto_psv ) ) _MI2C2Interrupt ( void )
                 // Set the flag to acknowledge the data
                 I2C2_ACKNOWLEDGE_DATA_BIT = 0;
 
+                // Initiate the acknowledge
+                I2C2_ACKNOWLEDGE_ENABLE_BIT = 1;
+
                 // Wait for the acknowledge to complete, then get more
                 i2c2_state = S_MASTER_RCV_DATA;
+
+                // at fast clocks the acknowledge is over within a few
+                // instructions, so rather than take an interrupt for it,
+                // wait here and receive the next byte at once. This makes
+                // a bulk read one interrupt per byte instead of two
+                if (I2C2BRG <= I2C2_ACK_WAIT_BRG_MAX)
+                {
+                    ack_wait = I2C2_ACK_WAIT_LOOPS;
+                    while (I2C2_ACKNOWLEDGE_ENABLE_BIT && --ack_wait)
+                    {
+                    }
+
+                    // a slave stretching the clock is left to the interrupt
+                    if (!I2C2_ACKNOWLEDGE_ENABLE_BIT)
+                    {
+                        // the acknowledge set the flag on its way out. It
+                        // is cleared before the next byte is received, so
+                        // the flag of that byte cannot be lost
+                        IFS3bits.MI2C2IF = 0;
+
+                        i2c2_state = S_MASTER_ACK_RCV_DATA;
+                        I2C2_RECEIVE_ENABLE_BIT = 1;
+                    }
+                }
             }
             else
             {
@@ -528,10 +619,10 @@ void __attribute__ ( ( interrupt, no_auto_psv ) ) _MI2C2Interrupt ( void )
                 I2C2_ACKNOWLEDGE_DATA_BIT = 1;
 
                 I2C2_FunctionComplete();
-            }
 
-            // Initiate the acknowledge
-            I2C2_ACKNOWLEDGE_ENABLE_BIT = 1;
+                // Initiate the acknowledge
+                I2C2_ACKNOWLEDGE_ENABLE_BIT = 1;
+            }
             break;
 
         case S_MASTER_RCV_STOP:                
@@ -582,30 +673,258 @@ static void I2C2_Stop(I2C2_MESSAGE_STATUS completion_code)
         *(p_i2c2_current->pTrFlag) = completion_code;
     }
 
+    // let the owner know. This is done before going idle, so that
+    // anything it queues is started by the stop interrupt rather
+    // than while the stop condition is still on the bus
+    if (p_i2c2_current->callback != NULL)
+    {
+        p_i2c2_current->callback(completion_code, p_i2c2_current->context);
+    }
+
+    // the list is finished, so nothing that follows may complete it again
+    p_i2c2_current = NULL;
+
     // Done, back to idle
     i2c2_state = S_MASTER_IDLE;
     
 }
 
-void I2C2_MasterWrite(
-                                uint8_t *pdata,
-                                uint8_t length,
-                                uint16_t address,
-                                I2C2_MESSAGE_STATUS *pstatus)
+static void I2C2_ModuleEnable(void)
+{
+    // Baud Rate Generator Value: the bus speed, until a slave with a profile is addressed
+    I2C2BRG = i2c2_bus_profile.brg;
+    // ACKEN disabled; STRICT disabled; STREN disabled; GCEN disabled; SMEN disabled; DISSLW enabled; I2CSIDL disabled; ACKDT Sends ACK; SCLREL Holds; RSEN disabled; A10M 7 Bit; PEN disabled; RCEN disabled; SEN disabled; I2CEN enabled; 
+    I2C2CONL = 0x8000;
+    I2C2CONLbits.DISSLW = i2c2_bus_profile.disslw;
+    // BCL disabled; D_nA disabled; R_nW disabled; P disabled; S disabled; I2COV disabled; IWCOL disabled; 
+    I2C2STAT = 0x00;
+}
+
+static void I2C2_QueueAdvance(void)
 {
-    static I2C2_TRANSACTION_REQUEST_BLOCK   trBlock;
+    i2c2_object.pTrHead++;
 
-    // check if there is space in the queue
-    if (i2c2_object.trStatus.s.full != true)
+    // check if the end of the array is reached
+    if(i2c2_object.pTrHead == (i2c2_tr_queue + I2C2_CONFIG_TR_QUEUE_LENGTH))
+    {
+        // adjust to restart at the beginning of the array
+        i2c2_object.pTrHead = i2c2_tr_queue;
+    }
+
+    // since we moved one item to be processed, we know
+    // it is not full, so set the full status to false
+    i2c2_object.trStatus.s.full = false;
+
+    // check if the queue is empty
+    if(i2c2_object.pTrHead == i2c2_object.pTrTail)
+    {
+        // it is empty so set the empty status to true
+        i2c2_object.trStatus.s.empty = true;
+    }
+}
+
+static void I2C2_Fail(I2C2_MESSAGE_STATUS completion_code)
+{
+    // a list is only on the bus between the idle state and its stop;
+    // a collision outside of that has no list to fail
+    bool active = (i2c2_state != S_MASTER_IDLE);
+
+    // no stop is sent, the module has already lost the bus
+    i2c2_state = S_MASTER_IDLE;
+
+    if (active && (p_i2c2_current != NULL))
+    {
+        if (p_i2c2_current->pTrFlag != NULL)
+        {
+            *(p_i2c2_current->pTrFlag) = completion_code;
+        }
+
+        // let the owner know
+        if (p_i2c2_current->callback != NULL)
+        {
+            p_i2c2_current->callback(completion_code, p_i2c2_current->context);
+        }
+
+        // reset the buffer pointer
+        p_i2c2_current = NULL;
+    }
+
+    // no stop interrupt will follow, so start anything still queued now
+    if (i2c2_object.trStatus.s.empty != true)
+    {
+        IFS3bits.MI2C2IF = 1;
+    }
+}
+
+void I2C2_MasterAbort(I2C2_MESSAGE_STATUS completion_code)
+{
+    I2C_TR_QUEUE_ENTRY aborted[I2C2_CONFIG_TR_QUEUE_LENGTH + 1];
+    uint8_t count = 0;
+    uint8_t i;
+
+    // stop the state machine, and let go of the bus
+    IEC3bits.MI2C2IE = 0;
+    I2C2CONLbits.I2CEN = 0;
+    IFS3bits.MI2C2IF = 0;
+
+    // take everything out of the queue before anyone is told, so that
+    // anything the callbacks insert waits for I2C2_MasterResume
+    if ((i2c2_state != S_MASTER_IDLE) && (p_i2c2_current != NULL))
+    {
+        aborted[count++] = *p_i2c2_current;
+    }
+    while (i2c2_object.trStatus.s.empty != true)
     {
-        I2C2_MasterWriteTRBBuild(&trBlock, pdata, length, address);
-        I2C2_MasterTRBInsert(1, &trBlock, pstatus);
+        aborted[count++] = *i2c2_object.pTrHead;
+        I2C2_QueueAdvance();
+    }
+
+    i2c2_state = S_MASTER_IDLE;
+    p_i2c2_current = NULL;
+
+    for (i = 0; i < count; i++)
+    {
+        if (aborted[i].pTrFlag != NULL)
+        {
+            *(aborted[i].pTrFlag) = completion_code;
+        }
+        if (aborted[i].callback != NULL)
+        {
+            aborted[i].callback(completion_code, aborted[i].context);
+        }
+    }
+}
+
+void I2C2_MasterResume(void)
+{
+    I2C2_ModuleEnable();
+
+    // start anything queued since the abort
+    IFS3bits.MI2C2IF = (i2c2_object.trStatus.s.empty != true);
+    IEC3bits.MI2C2IE = 1;
+}
+
+static uint32_t I2C2_ProfileCompute(I2C_SPEED_PROFILE *pprofile, uint32_t frequency)
+{
+    uint32_t period = 1000000000UL / frequency;
+    uint32_t halfPeriod = 0;
+    uint32_t actual;
+
+    // I2CxBRG = ((1/FSCL - PGD) * FCY / 2) - 2, rounded up so that the
+    // clock is never faster than asked for
+    if (period > I2C2_PGD_NS)
+    {
+        halfPeriod = (uint32_t)(((uint64_t)(period - I2C2_PGD_NS) * CLOCK_InstructionFrequencyGet()
+                                 + 1999999999ULL) / 2000000000ULL);
+    }
+
+    if (halfPeriod < I2C2_BRG_MIN + 2)
+    {
+        pprofile->brg = I2C2_BRG_MIN;
+    }
+    else if (halfPeriod > 0xFFFFUL + 2)
+    {
+        pprofile->brg = 0xFFFF;
     }
     else
     {
-        *pstatus = I2C2_MESSAGE_FAIL;
+        pprofile->brg = (uint16_t)(halfPeriod - 2);
+    }
+
+    // slew rate control is meant for fast mode, up to 400 kHz. The
+    // frequency is kept, as it is asked for with every transfer
+    actual = I2C2_BaudRateFrequency(pprofile->brg);
+    pprofile->disslw = (actual <= I2C2_SPEED_STANDARD) || (actual > I2C2_SPEED_FAST);
+    pprofile->frequency = actual;
+
+    return actual;
+}
+
+static uint32_t I2C2_BaudRateFrequency(uint16_t brg)
+{
+    // FSCL = 1 / (((I2CxBRG + 2) * 2 / FCY) + PGD)
+    uint32_t period = (uint32_t)(((uint64_t)(brg + 2UL) * 2000000000ULL) / CLOCK_InstructionFrequencyGet())
+                      + I2C2_PGD_NS;
+
+    return 1000000000UL / period;
+}
+
+static I2C_SPEED_PROFILE *I2C2_ProfileFind(uint16_t address)
+{
+    uint8_t i;
+
+    for (i = 0; i < i2c2_profile_count; i++)
+    {
+        if (i2c2_profiles[i].address == address)
+        {
+            return &i2c2_profiles[i];
+        }
+    }
+
+    return &i2c2_bus_profile;
+}
+
+uint32_t I2C2_BusSpeedSet(uint32_t frequency)
+{
+    uint32_t actual;
+
+    // lists are started from the interrupt, which reads the profiles
+    uint8_t interruptEnabled = IEC3bits.MI2C2IE;
+    IEC3bits.MI2C2IE = 0;
+
+    actual = I2C2_ProfileCompute(&i2c2_bus_profile, frequency);
+
+    IEC3bits.MI2C2IE = interruptEnabled;
+    return actual;
+}
+
+uint32_t I2C2_SlaveSpeedSet(uint16_t address, uint32_t frequency)
+{
+    I2C_SPEED_PROFILE *pprofile;
+    uint32_t actual = 0;
+
+    // lists are started from the interrupt, which reads the profiles
+    uint8_t interruptEnabled = IEC3bits.MI2C2IE;
+    IEC3bits.MI2C2IE = 0;
+
+    pprofile = I2C2_ProfileFind(address);
+
+    if (frequency == 0)
+    {
+        // remove the profile, if there is one
+        if (pprofile != &i2c2_bus_profile)
+        {
+            *pprofile = i2c2_profiles[--i2c2_profile_count];
+        }
+        actual = i2c2_bus_profile.frequency;
     }
+    else if (pprofile != &i2c2_bus_profile)
+    {
+        actual = I2C2_ProfileCompute(pprofile, frequency);
+    }
+    else if (i2c2_profile_count < I2C2_CONFIG_SPEED_PROFILES)
+    {
+        pprofile = &i2c2_profiles[i2c2_profile_count++];
+        pprofile->address = address;
+        actual = I2C2_ProfileCompute(pprofile, frequency);
+    }
+
+    IEC3bits.MI2C2IE = interruptEnabled;
+    return actual;
+}
+
+uint32_t I2C2_SlaveSpeedGet(uint16_t address)
+{
+    return I2C2_ProfileFind(address)->frequency;
+}
 
+void I2C2_MasterWrite(
+                                uint8_t *pdata,
+                                uint8_t length,
+                                uint16_t address,
+                                I2C2_MESSAGE_STATUS *pstatus)
+{
+    I2C2_MasterPoolInsert(pdata, length, address, false, pstatus);
 }                           
 
 void I2C2_MasterRead(
@@ -614,27 +933,69 @@ void I2C2_MasterRead(
                                 uint16_t address,
                                 I2C2_MESSAGE_STATUS *pstatus)
 {
-    static I2C2_TRANSACTION_REQUEST_BLOCK   trBlock;
+    I2C2_MasterPoolInsert(pdata, length, address, true, pstatus);
+}       
 
+static void I2C2_MasterPoolInsert(
+                                uint8_t *pdata,
+                                uint8_t length,
+                                uint16_t address,
+                                bool read,
+                                I2C2_MESSAGE_STATUS *pstatus)
+{
+    I2C2_TRANSACTION_REQUEST_BLOCK *ptrb;
+
+    // keep the interrupt from inserting between taking a TRB and
+    // queueing it, so TRBs are queued in the order they are taken
+    uint8_t interruptEnabled = IEC3bits.MI2C2IE;
+    IEC3bits.MI2C2IE = 0;
 
     // check if there is space in the queue
     if (i2c2_object.trStatus.s.full != true)
     {
-        I2C2_MasterReadTRBBuild(&trBlock, pdata, length, address);
-        I2C2_MasterTRBInsert(1, &trBlock, pstatus);
+        ptrb = &i2c2_trb_pool[i2c2_trb_pool_next];
+        if (++i2c2_trb_pool_next == I2C2_TRB_POOL_LENGTH)
+        {
+            i2c2_trb_pool_next = 0;
+        }
+
+        if (read)
+        {
+            I2C2_MasterReadTRBBuild(ptrb, pdata, length, address);
+        }
+        else
+        {
+            I2C2_MasterWriteTRBBuild(ptrb, pdata, length, address);
+        }
+        I2C2_MasterTRBInsert(1, ptrb, pstatus);
     }
     else
     {
         *pstatus = I2C2_MESSAGE_FAIL;
     }
 
-}       
+    IEC3bits.MI2C2IE = interruptEnabled;
+}
 
 void I2C2_MasterTRBInsert(
                                 uint8_t count,
                                 I2C2_TRANSACTION_REQUEST_BLOCK *ptrb_list,
                                 I2C2_MESSAGE_STATUS *pflag)
 {
+    I2C2_MasterTRBInsertCallback(count, ptrb_list, pflag, NULL, NULL);
+}
+
+void I2C2_MasterTRBInsertCallback(
+                                uint8_t count,
+                                I2C2_TRANSACTION_REQUEST_BLOCK *ptrb_list,
+                                I2C2_MESSAGE_STATUS *pflag,
+                                I2C2_CALLBACK callback,
+                                void *context)
+{
+    // completion callbacks may insert from the interrupt, so keep
+    // it out while the queue is being changed
+    uint8_t interruptEnabled = IEC3bits.MI2C2IE;
+    IEC3bits.MI2C2IE = 0;
 
     // check if there is space in the queue
     if (i2c2_object.trStatus.s.full != true)
@@ -644,6 +1005,8 @@ void I2C2_MasterTRBInsert(
         i2c2_object.pTrTail->ptrb_list = ptrb_list;
         i2c2_object.pTrTail->count     = count;
         i2c2_object.pTrTail->pTrFlag   = pflag;
+        i2c2_object.pTrTail->callback  = callback;
+        i2c2_object.pTrTail->context   = context;
         i2c2_object.pTrTail++;
 
         // check if the end of the array is reached
@@ -678,6 +1041,8 @@ void I2C2_MasterTRBInsert(
         *pflag = I2C2_MESSAGE_FAIL;
     }
 
+    IEC3bits.MI2C2IE = interruptEnabled;
+
 }      
                                 
 void I2C2_MasterReadTRBBuild(
@@ -714,6 +1079,21 @@ bool I2C2_MasterQueueIsFull(void)
     return((bool)i2c2_object.trStatus.s.full);
 }
 
+void I2C2_MasterIdleRequest(void)
+{
+    // otherwise the interrupt of the list on the bus, or of its stop,
+    // is still to come, and goes idle on its own
+    if(i2c2_state == S_MASTER_IDLE)
+    {
+        IFS3bits.MI2C2IF = 1;
+    }
+}
+
+void __attribute__ ((weak)) I2C2_MasterIdleCallBack(void)
+{
+    // Add your custom callback code here
+}
+
 /**
  End of File
 */
@@ -61,6 +61,74 @@
 
 #endif
 
+/**
+ Section: Macro Definitions
+*/
+
+/**
+  I2C Driver Queue Depth
+
+  @Summary
+    The number of TRB lists that can wait in the queue.
+
+  @Description
+    Each entry of the queue holds one TRB list, inserted by
+    I2C2_MasterTRBInsert, I2C2_MasterTRBInsertCallback, I2C2_MasterWrite
+    or I2C2_MasterRead, on top of the one on the bus. Lists that wait are
+    started back to back, from the interrupt of the stop condition of the
+    one before. Define it before including this file, or on the command
+    line, to change it.
+ */
+#ifndef I2C2_CONFIG_TR_QUEUE_LENGTH
+        #define I2C2_CONFIG_TR_QUEUE_LENGTH 8
+#endif
+
+/**
+  I2C Bus Speeds
+
+  @Summary
+    The SCL frequencies of the standard, fast and fast plus modes, in Hz.
+
+  @Description
+    These are the limits of each mode. The clock is derived from Fcy, and
+    rounds down to the nearest frequency the baud rate generator can make,
+    so it may be slower than the one asked for. At Fcy = 2 MHz the fastest
+    clock is about 242 kHz, so fast mode runs slower than its limit and
+    fast plus cannot be reached.
+ */
+#define I2C2_SPEED_STANDARD     100000UL
+#define I2C2_SPEED_FAST         400000UL
+#define I2C2_SPEED_FAST_PLUS    1000000UL
+
+/**
+  I2C Default Bus Speed
+
+  @Summary
+    The SCL frequency of every slave without a speed profile, in Hz.
+
+  @Description
+    Define it before including this file, or on the command line, to change
+    it. I2C2_BusSpeedSet changes it at run time.
+ */
+#ifndef I2C2_CONFIG_BUS_SPEED
+        #define I2C2_CONFIG_BUS_SPEED I2C2_SPEED_STANDARD
+#endif
+
+/**
+  I2C Speed Profiles
+
+  @Summary
+    The number of slaves that can have a speed of their own.
+
+  @Description
+    Each profile holds the baud rate of one slave address, set by
+    I2C2_SlaveSpeedSet. Define it before including this file, or on the
+    command line, to change it.
+ */
+#ifndef I2C2_CONFIG_SPEED_PROFILES
+        #define I2C2_CONFIG_SPEED_PROFILES 4
+#endif
+
 /**
  Section: Data Type Definitions
 */
@@ -89,7 +157,9 @@ typedef enum
     I2C2_STUCK_START,
     I2C2_MESSAGE_ADDRESS_NO_ACK,
     I2C2_DATA_NO_ACK,
-    I2C2_LOST_STATE
+    I2C2_LOST_STATE,
+    I2C2_BUS_COLLISION,
+    I2C2_MESSAGE_TIMEOUT
 } I2C2_MESSAGE_STATUS;
 
 /**
@@ -114,6 +184,25 @@ typedef struct
     uint8_t   length;           // the # of bytes in the buffer
     uint8_t   *pbuffer;         // a pointer to a buffer of length bytes
 } I2C2_TRANSACTION_REQUEST_BLOCK;
+
+/**
+  I2C Driver Completion Callback Type
+
+  @Summary
+    Defines the function called when a list of TRBs completes.
+
+  @Description
+    A completion callback is called from the I2C2 master interrupt once
+    the completion flag of its TRB list has been updated. It is given the
+    same completion code as the flag, and the context pointer that was
+    inserted along with the TRB list.
+
+    The callback runs at interrupt priority, so it must be short. It may
+    insert new TRB lists into the queue; they are started as soon as the
+    stop condition of the completed list is done.
+
+ */
+typedef void (*I2C2_CALLBACK)(I2C2_MESSAGE_STATUS status, void *context);
         
 /**
   Section: Interface Routines
@@ -244,6 +333,10 @@ void I2C2_Initialize(void);
         Finally, it waits for the transaction to complete and returns
         the result.
 
+        The TRB is built in a pool owned by the driver, with a TRB for
+        every entry of the queue and the one on the bus, so it stays
+        valid until the transaction completes.
+
     @Preconditions
         None
 
@@ -287,6 +380,10 @@ void I2C2_MasterWrite(
         Finally, it waits for the transaction to complete and returns
         the result.
 
+        The TRB is built in a pool owned by the driver, with a TRB for
+        every entry of the queue and the one on the bus, so it stays
+        valid until the transaction completes.
+
     @Preconditions
         None
 
@@ -570,6 +667,53 @@ void I2C2_MasterTRBInsert(
                                 uint8_t count,
                                 I2C2_TRANSACTION_REQUEST_BLOCK *ptrb_list,
                                 I2C2_MESSAGE_STATUS *pflag);
+
+/**
+    @Summary
+        Inserts a list of i2c transaction requests into the i2c
+        transaction queue, with a function to call on completion.
+
+    @Description
+        This function behaves like I2C2_MasterTRBInsert(). In addition,
+        when the list of transactions is complete (or fails), the callback
+        is called from the i2c interrupt with the completion code and the
+        supplied context pointer.
+
+        If there is no space in the queue, the flag is set to
+        I2C2_MESSAGE_FAIL and the callback is not called.
+
+        The TRB list, the data buffers and the flag must remain valid
+        until the callback has been called.
+
+    @Preconditions
+        None
+
+    @Param
+        count - The numer of transaction requests in the trb_list.
+
+    @Param
+        *ptrb_list - A pointer to an array of transaction requests (TRB).
+            See I2C2_TRANSACTION_REQUEST_BLOCK definition for details.
+
+    @Param
+        *pflag - A pointer to a completion flag.
+
+    @Param
+        callback - The function to call on completion, or NULL.
+
+    @Param
+        *context - A pointer passed back to the callback.
+
+    @Returns
+        None
+*/
+
+void I2C2_MasterTRBInsertCallback(
+                                uint8_t count,
+                                I2C2_TRANSACTION_REQUEST_BLOCK *ptrb_list,
+                                I2C2_MESSAGE_STATUS *pflag,
+                                I2C2_CALLBACK callback,
+                                void *context);
                                 
 /**
     @Summary
@@ -661,6 +805,140 @@ void I2C2_MasterWriteTRBBuild(
                                 uint8_t length,
                                 uint16_t address);                           
                                 
+/**
+    @Summary
+        Fails every TRB list, and lets go of the bus
+
+    @Description
+        This function disables the I2C2 module, which releases SCL and
+        SDA, and takes the list on the bus and every list in the queue
+        out of the driver. Each one then has its flag set to
+        completion_code, and its callback called, from the caller of this
+        function rather than the interrupt.
+
+        Lists inserted after this, including by those callbacks, wait
+        until I2C2_MasterResume.
+
+    @Preconditions
+        I2C2_Initialize() should have been called.
+
+    @Param
+        completion_code - The status given to every list.
+
+    @Returns
+        None
+
+    @Example
+        <code>
+            I2C2_MasterAbort(I2C2_MESSAGE_TIMEOUT);
+            // SCL and SDA are port pins until the module is resumed
+            I2C2_MasterResume();
+        </code>
+*/
+void I2C2_MasterAbort(I2C2_MESSAGE_STATUS completion_code);
+
+/**
+    @Summary
+        Enables the I2C2 module again after I2C2_MasterAbort
+
+    @Description
+        This function enables the I2C2 module with the configuration and
+        baud rate it had, and starts any list inserted since the abort.
+
+    @Preconditions
+        I2C2_MasterAbort() should have been called.
+
+    @Param
+        None
+
+    @Returns
+        None
+*/
+void I2C2_MasterResume(void);
+
+/**
+    @Summary
+        Sets the SCL frequency of every slave without a speed profile
+
+    @Description
+        This function derives the baud rate from Fcy, rounded so the clock
+        is never faster than frequency, and enables slew rate control if
+        the clock falls in fast mode. It applies from the next TRB list
+        started for such a slave; the list on the bus, if any, finishes at
+        the old speed.
+
+    @Preconditions
+        I2C2_Initialize() should have been called.
+
+    @Param
+        frequency - The SCL frequency, in Hz, such as I2C2_SPEED_STANDARD.
+
+    @Returns
+        The SCL frequency that was achieved, in Hz.
+
+    @Example
+        <code>
+            if (I2C2_BusSpeedSet(I2C2_SPEED_FAST) < I2C2_SPEED_FAST)
+            {
+                // the clock is as fast as Fcy allows, but no faster
+            }
+        </code>
+*/
+uint32_t I2C2_BusSpeedSet(uint32_t frequency);
+
+/**
+    @Summary
+        Sets the SCL frequency used with one slave
+
+    @Description
+        This function gives a slave a speed profile of its own, or changes
+        the one it has. TRB lists addressed to it run at that speed, and
+        the baud rate generator is only reloaded between lists, when the
+        bus is idle, and only if the speed changes. A list is run at the
+        speed of the slave its first TRB addresses.
+
+    @Preconditions
+        I2C2_Initialize() should have been called.
+
+    @Param
+        address - The 7 bit or 10 bit address of the slave.
+
+    @Param
+        frequency - The SCL frequency, in Hz, or 0 to remove the profile so
+        the slave runs at the bus speed again.
+
+    @Returns
+        The SCL frequency that was achieved, in Hz, or 0 if every profile
+        is taken.
+
+    @Example
+        <code>
+            #define SENSOR_ADDRESS 0x42
+
+            I2C2_SlaveSpeedSet(SENSOR_ADDRESS, I2C2_SPEED_FAST);
+        </code>
+*/
+uint32_t I2C2_SlaveSpeedSet(uint16_t address, uint32_t frequency);
+
+/**
+    @Summary
+        Gets the SCL frequency used with one slave
+
+    @Description
+        This function returns the speed of the profile of the slave, or the
+        bus speed if it has none.
+
+    @Preconditions
+        I2C2_Initialize() should have been called.
+
+    @Param
+        address - The 7 bit or 10 bit address of the slave.
+
+    @Returns
+        The SCL frequency, in Hz.
+*/
+uint32_t I2C2_SlaveSpeedGet(uint16_t address);
+
 /**
     @Summary
         This function returns the empty status of the Master
@@ -737,6 +1015,50 @@ bool I2C2_MasterQueueIsEmpty(void);
 
 bool I2C2_MasterQueueIsFull(void);             
 
+/**
+    @Summary
+        Has I2C2_MasterIdleCallBack called from the I2C2 interrupt
+
+    @Description
+        This function raises the I2C2 interrupt if no TRB list is on the
+        bus; otherwise that interrupt is coming anyway, for the list or
+        its stop. Either way I2C2_MasterIdleCallBack is called from it
+        once the bus and the queue are idle.
+
+        Use this from an interrupt that cannot insert TRB lists itself,
+        since lists are inserted from the main loop with only the I2C2
+        interrupt masked.
+
+    @Preconditions
+        I2C2_Initialize() should have been called.
+
+    @Param
+        None
+
+    @Returns
+        None
+*/
+void I2C2_MasterIdleRequest(void);
+
+/**
+    @Summary
+        Callback for the I2C2 driver going idle
+
+    @Description
+        This routine is called from the I2C2 interrupt whenever it finds
+        the bus idle and the queue empty, which is after the stop of every
+        list, and after I2C2_MasterIdleRequest. It may insert TRB lists,
+        and the next interrupt starts them. The default implementation is
+        empty and weakly linked; define it elsewhere to handle the event.
+
+    @Param
+        None
+
+    @Returns
+        None
+*/
+void I2C2_MasterIdleCallBack(void);
+
 #ifdef __cplusplus  // Provide C++ Compatibility
 
     }
@@ -0,0 +1,114 @@
+/**
+  IC1 Generated Driver File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    ic1.c
+
+  @Summary
+    This is the generated driver implementation file for the IC1 driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This source file provides APIs for IC1.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+/**
+  Section: Included Files
+*/
+
+#include <xc.h>
+#include "ic1.h"
+
+/**
+  IC Mode.
+
+  @Summary
+    Defines the IC Mode.
+
+  @Description
+    This data type defines the IC Mode of operation.
+
+*/
+
+static uint16_t         gIC1Mode;
+
+/**
+  Section: Driver Interface
+*/
+
+void IC1_Initialize (void)
+{
+    // ICSIDL disabled; ICM Simple Capture mode: every rising edge; ICTSEL TMR1; ICI Every; 
+    IC1CON1 = 0x1003;
+    // SYNCSEL None; TRIGSTAT disabled; IC32 disabled; ICTRIG Sync; 
+    IC1CON2 = 0x0000;
+
+    gIC1Mode = IC1CON1bits.ICM;
+
+    IFS0bits.IC1IF = false;
+    IEC0bits.IC1IE = true;
+}
+
+void __attribute__ ( ( interrupt, no_auto_psv ) ) _IC1Interrupt( void )
+{
+    if(IFS0bits.IC1IF)
+    {
+        // IC1 callback function 
+        IC1_CallBack();
+        IFS0bits.IC1IF = 0;
+    }
+}
+
+void __attribute__ ((weak)) IC1_CallBack(void)
+{
+    // Add your custom callback code here
+}
+
+uint16_t IC1_CaptureDataRead( void )
+{
+    return(IC1BUF);
+}
+
+bool IC1_HasCaptureBufferOverflowed( void )
+{
+    return( IC1CON1bits.ICOV );
+}
+
+bool IC1_IsCaptureBufferEmpty( void )
+{
+    return( ! IC1CON1bits.ICBNE );
+}
+
+/**
+ End of File
+*/
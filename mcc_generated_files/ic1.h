@@ -0,0 +1,154 @@
+/**
+  IC1 Generated Driver API Header File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    ic1.h
+
+  @Summary
+    This is the generated header file for the IC1 driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This header file provides APIs for driver for IC1.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+#ifndef _IC1_H
+#define _IC1_H
+
+/**
+  Section: Included Files
+*/
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+  Section: Interface Routines
+*/
+
+/**
+  @Summary
+    This function initializes IC instance : 1
+
+  @Description
+    This routine initializes the IC driver instance for : 1
+    index, making it ready for clients to open and use it.
+
+    IC1 captures Timer1 on every rising edge of the pin that PPS maps to
+    it, and interrupts on every capture.
+
+  @Param
+    None.
+
+  @Returns
+    None.
+
+  @Example
+    <code>
+    IC1_Initialize();
+    </code>
+*/
+void IC1_Initialize(void);
+
+/**
+  @Summary
+    Reads the captured data from buffer
+
+  @Description
+    This routine reads the captured data from buffer
+
+  @Param
+    None.
+
+  @Returns
+    Read data from buffer
+*/
+uint16_t IC1_CaptureDataRead( void );
+
+/**
+  @Summary
+    Returns if the capture buffer has overflowed
+
+  @Description
+    This routine returns true if captures were lost because the buffer was
+    full, and false otherwise.
+
+  @Param
+    None.
+
+  @Returns
+    true  - capture buffer has overflowed
+    false - capture buffer has not overflowed
+*/
+bool IC1_HasCaptureBufferOverflowed( void );
+
+/**
+  @Summary
+    Returns if the capture buffer is empty
+
+  @Description
+    This routine returns true if there is no capture left to read from the
+    buffer, and false otherwise.
+
+  @Param
+    None.
+
+  @Returns
+    true  - capture buffer is empty
+    false - capture buffer is not empty
+*/
+bool IC1_IsCaptureBufferEmpty( void );
+
+/**
+  @Summary
+    Callback for IC1
+
+  @Description
+    This routine is called from the IC1 interrupt handler on every capture.
+    The default implementation is empty and weakly linked; define it
+    elsewhere to handle the interrupt.
+
+  @Param
+    None.
+
+  @Returns
+    None.
+*/
+void IC1_CallBack(void);
+
+#endif //_IC1_H
+
+/**
+ End of File
+*/
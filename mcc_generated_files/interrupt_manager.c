@@ -52,6 +52,18 @@
 */
 void INTERRUPT_Initialize (void)
 {
+    //    INT1I: INT1 - External Interrupt 1
+    //    Priority: 1
+        IPC5bits.INT1IP = 1;
+    //    ICI: IC1 - Input Capture 1
+    //    Priority: 1
+        IPC0bits.IC1IP = 1;
+    //    TI: T1 - Timer1
+    //    Priority: 1
+        IPC0bits.T1IP = 1;
+    //    TI: T3 - Timer3
+    //    Priority: 1
+        IPC2bits.T3IP = 1;
     //    MICI: MI2C2 - I2C2 Master Events
     //    Priority: 1
         IPC12bits.MI2C2IP = 1;
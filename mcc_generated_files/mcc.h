@@ -55,6 +55,11 @@
 #include "traps.h"
 #include "spi1.h"
 #include "i2c2.h"
+#include "ext_int.h"
+#include "tmr1.h"
+#include "ic1.h"
+#include "rtcc.h"
+#include "tmr2.h"
 
 #ifndef _XTAL_FREQ
 #define _XTAL_FREQ  4000000UL
@@ -112,6 +112,8 @@ void PIN_MANAGER_Initialize (void)
     RPINR18bits.U1RXR = 0x0011;    //RC1->UART1:U1RX
     RPINR20bits.SDI1R = 0x0008;    //RB8->SPI1:SDI1
     RPOR4bits.RP9R = 0x0007;    //RB9->SPI1:SDO1
+    RPINR0bits.INT1R = 0x0007;    //RB7->EXT_INT:INT1
+    RPINR7bits.IC1R = 0x0006;    //RB6->IC1:IC1
 
     __builtin_write_OSCCONL(OSCCON | 0x40); // lock PPS
 
@@ -0,0 +1,143 @@
+/**
+  RTCC Generated Driver File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    rtcc.c
+
+  @Summary
+    This is the generated driver implementation file for the RTCC driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This source file provides APIs for RTCC.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+/**
+ Section: Included Files
+*/
+
+#include <xc.h>
+#include "rtcc.h"
+
+/**
+// Section: Static function
+*/
+
+static uint8_t ConvertHexToBCD(uint8_t hexvalue);
+static uint8_t ConvertBCDToHex(uint8_t bcdvalue);
+
+/**
+// Section: Driver Interface Function Definitions
+*/
+
+void RTCC_Initialize(void)
+{
+   // Set the RTCWREN bit
+   __builtin_write_RTCWEN();
+
+   RCFGCALbits.RTCEN = 0;
+
+   // RTCOUT Alarm Pulse; PWSPRE disabled; RTCLK SOSC; PWCPRE disabled; PWCEN disabled; PWCPOL disabled; 
+   RTCPWC = 0x0000;
+
+   // Enable RTCC, clear RTCWREN
+   RCFGCALbits.RTCEN = 1;
+   RCFGCALbits.RTCWREN = 0;
+}
+
+bool RTCC_TimeGet(struct tm *currentTime)
+{
+    uint16_t register_value;
+    if(RCFGCALbits.RTCSYNC){
+        return false;
+    }
+
+    RCFGCALbits.RTCPTR = 3;
+    register_value = RTCVAL;
+    currentTime->tm_year = ConvertBCDToHex(register_value & 0x00FF);
+
+    RCFGCALbits.RTCPTR = 2;
+    register_value = RTCVAL;
+    currentTime->tm_mon = ConvertBCDToHex((register_value & 0xFF00) >> 8);
+    currentTime->tm_mday = ConvertBCDToHex(register_value & 0x00FF);
+
+    RCFGCALbits.RTCPTR = 1;
+    register_value = RTCVAL;
+    currentTime->tm_wday = ConvertBCDToHex((register_value & 0xFF00) >> 8);
+    currentTime->tm_hour = ConvertBCDToHex(register_value & 0x00FF);
+
+    RCFGCALbits.RTCPTR = 0;
+    register_value = RTCVAL;
+    currentTime->tm_min = ConvertBCDToHex((register_value & 0xFF00) >> 8);
+    currentTime->tm_sec = ConvertBCDToHex(register_value & 0x00FF);
+
+    return true;
+}
+
+void RTCC_TimeSet(struct tm *initialTime)
+{
+   // Set the RTCWREN bit
+   __builtin_write_RTCWEN();
+
+   RCFGCALbits.RTCEN = 0;
+
+   // set RTCC initial time, the pointer counts down with every write
+   RCFGCALbits.RTCPTR = 3;
+   RTCVAL = ConvertHexToBCD(initialTime->tm_year);
+   RTCVAL = (ConvertHexToBCD(initialTime->tm_mon) << 8) | ConvertHexToBCD(initialTime->tm_mday);
+   RTCVAL = (ConvertHexToBCD(initialTime->tm_wday) << 8) | ConvertHexToBCD(initialTime->tm_hour);
+   RTCVAL = (ConvertHexToBCD(initialTime->tm_min) << 8) | ConvertHexToBCD(initialTime->tm_sec);
+
+   // Enable RTCC, clear RTCWREN
+   RCFGCALbits.RTCEN = 1;
+   RCFGCALbits.RTCWREN = 0;
+}
+
+static uint8_t ConvertHexToBCD(uint8_t hexvalue)
+{
+    uint8_t bcdvalue;
+    bcdvalue = (hexvalue / 10) << 4;
+    bcdvalue = bcdvalue | (hexvalue % 10);
+    return (bcdvalue);
+}
+
+static uint8_t ConvertBCDToHex(uint8_t bcdvalue)
+{
+    uint8_t hexvalue;
+    hexvalue = (((bcdvalue & 0xF0) >> 4)* 10) + (bcdvalue & 0x0F);
+    return hexvalue;
+}
+
+/**
+ End of File
+*/
@@ -0,0 +1,121 @@
+/**
+  RTCC Generated Driver API Header File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    rtcc.h
+
+  @Summary
+    This is the generated header file for the RTCC driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This header file provides APIs for driver for RTCC.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+#ifndef _RTCC_H
+#define _RTCC_H
+
+/**
+ Section: Included Files
+*/
+
+#include <xc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ Section: Interface Routines
+*/
+
+/**
+  @Summary
+    Initializes and enables the Real Time Clock and Calendar module
+
+  @Description
+    This routine initializes the RTCC, clocked from the SOSC, and enables
+    it without changing the time it holds.
+
+  @Param
+    None.
+
+  @Returns
+    None
+
+  @Example
+    <code>
+    RTCC_Initialize();
+    </code>
+*/
+void RTCC_Initialize(void);
+
+/**
+  @Summary
+    Returns the current time from the RTCC module
+
+  @Description
+    This routine returns the current time from the RTCC module. The fields
+    are as the RTCC keeps them: tm_year counts years since 2000, and
+    tm_mon runs from 1 to 12.
+
+  @Param
+    currentTime - the current time.
+
+  @Returns
+    true  - the time was read
+    false - the RTCC was rolling over, and should be read again
+*/
+bool RTCC_TimeGet(struct tm *currentTime);
+
+/**
+  @Summary
+    Sets the time of the RTCC module
+
+  @Description
+    This routine stops the RTCC, sets its time, and restarts it. The fields
+    are as the RTCC keeps them: tm_year counts years since 2000, and
+    tm_mon runs from 1 to 12.
+
+  @Param
+    initialTime - the time to set.
+
+  @Returns
+    None
+*/
+void RTCC_TimeSet(struct tm *initialTime);
+
+#endif // _RTCC_H
+
+/**
+ End of File
+*/
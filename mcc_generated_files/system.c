@@ -50,6 +50,11 @@
 #include "traps.h"
 #include "spi1.h"
 #include "i2c2.h"
+#include "ext_int.h"
+#include "tmr1.h"
+#include "ic1.h"
+#include "rtcc.h"
+#include "tmr2.h"
 
 void SYSTEM_Initialize(void)
 {
@@ -59,6 +64,11 @@ void SYSTEM_Initialize(void)
     SPI1_Initialize();
     I2C2_Initialize();
     UART1_Initialize();
+    EXT_INT_Initialize();
+    TMR1_Initialize();
+    IC1_Initialize();
+    RTCC_Initialize();
+    TMR2_Initialize();
 }
 
 /**
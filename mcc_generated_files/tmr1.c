@@ -0,0 +1,125 @@
+/**
+  TMR1 Generated Driver File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    tmr1.c
+
+  @Summary
+    This is the generated driver implementation file for the TMR1 driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This source file provides APIs for TMR1.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+/**
+  Section: Included Files
+*/
+
+#include <xc.h>
+#include "tmr1.h"
+
+/**
+  Section: Driver Interface
+*/
+
+void TMR1_Initialize (void)
+{
+    //TMR1 0; 
+    TMR1 = 0x00;
+    //Period = 2.09712 s; Frequency = 2000000 Hz; PR1 65535; 
+    PR1 = 0xFFFF;
+    //TCKPS 1:64; TON enabled; TSIDL disabled; TCS FOSC/2; TECS SOSC; TSYNC disabled; TGATE disabled; 
+    T1CON = 0x8020;
+
+    IFS0bits.T1IF = false;
+    IEC0bits.T1IE = true;
+}
+
+void __attribute__ ( ( interrupt, no_auto_psv ) ) _T1Interrupt (  )
+{
+    /* Check if the Timer Interrupt/Status is set */
+
+    //***User Area Begin
+
+    // ticker function call;
+    // ticker is 1 -> Callback function gets called everytime this ISR executes
+    TMR1_CallBack();
+
+    //***User Area End
+
+    IFS0bits.T1IF = false;
+}
+
+void TMR1_Period16BitSet( uint16_t value )
+{
+    /* Update the counter values */
+    PR1 = value;
+}
+
+uint16_t TMR1_Period16BitGet( void )
+{
+    return( PR1 );
+}
+
+void TMR1_Counter16BitSet ( uint16_t value )
+{
+    /* Update the counter values */
+    TMR1 = value;
+}
+
+uint16_t TMR1_Counter16BitGet( void )
+{
+    return( TMR1 );
+}
+
+void __attribute__ ((weak)) TMR1_CallBack(void)
+{
+    // Add your custom callback code here
+}
+
+void TMR1_Start( void )
+{
+    /* Start the Timer */
+    T1CONbits.TON = 1;
+}
+
+void TMR1_Stop( void )
+{
+    /* Stop the Timer */
+    T1CONbits.TON = false;
+}
+
+/**
+ End of File
+*/
@@ -0,0 +1,146 @@
+/**
+  TMR2 Generated Driver File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    tmr2.c
+
+  @Summary
+    This is the generated driver implementation file for the TMR2 driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This source file provides APIs for TMR2.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+/**
+  Section: Included Files
+*/
+
+#include <xc.h>
+#include "tmr2.h"
+
+/**
+  Section: Driver Interface
+*/
+
+void TMR2_Initialize (void)
+{
+    //TMR3 0; 
+    TMR3 = 0x00;
+    //TMR2 0; 
+    TMR2 = 0x00;
+    //Period = 2147.4836475 s; Frequency = 2000000 Hz; PR3 65535; 
+    PR3 = 0xFFFF;
+    //PR2 65535; 
+    PR2 = 0xFFFF;
+    //TCKPS 1:1; T32 32 Bit; TON enabled; TSIDL disabled; TCS FOSC/2; TECS SOSC; TGATE disabled; 
+    T2CON = 0x8008;
+
+    IFS0bits.T3IF = false;
+    IEC0bits.T3IE = true;
+}
+
+void __attribute__ ( ( interrupt, no_auto_psv ) ) _T3Interrupt (  )
+{
+    /* Check if the Timer Interrupt/Status is set */
+
+    //***User Area Begin
+
+    // ticker function call;
+    // ticker is 1 -> Callback function gets called everytime this ISR executes
+    TMR2_CallBack();
+
+    //***User Area End
+
+    IFS0bits.T3IF = false;
+}
+
+void TMR2_Period32BitSet( uint32_t value )
+{
+    /* Update the counter values */
+    PR2 = (value & 0x0000FFFF);
+    PR3 = ((value & 0xFFFF0000)>>16);
+}
+
+uint32_t TMR2_Period32BitGet( void )
+{
+    uint32_t periodVal = 0xFFFFFFFF;
+
+    /* get the timer period value and return it */
+    periodVal = (((uint32_t)PR3 <<16) | PR2);
+
+    return( periodVal );
+}
+
+void TMR2_Counter32BitSet( uint32_t value )
+{
+    /* Update the counter values */
+   TMR3HLD = ((value & 0xFFFF0000)>>16);
+   TMR2 = (value & 0x0000FFFF);
+}
+
+uint32_t TMR2_Counter32BitGet( void )
+{
+    uint32_t countVal = 0xFFFFFFFF;
+    uint16_t countValUpper;
+    uint16_t countValLower;
+
+    countValLower = TMR2;
+    countValUpper = TMR3HLD;
+
+    /* get the current counter value and return it */
+    countVal = (((uint32_t)countValUpper<<16)| countValLower );
+
+    return( countVal );
+}
+
+void __attribute__ ((weak)) TMR2_CallBack(void)
+{
+    // Add your custom callback code here
+}
+
+void TMR2_Start( void )
+{
+    /* Start the Timer */
+    T2CONbits.TON = 1;
+}
+
+void TMR2_Stop( void )
+{
+    /* Stop the Timer */
+    T2CONbits.TON = false;
+}
+
+/**
+ End of File
+*/
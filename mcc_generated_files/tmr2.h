@@ -0,0 +1,198 @@
+/**
+  TMR2 Generated Driver API Header File
+
+  @Company
+    Microchip Technology Inc.
+
+  @File Name
+    tmr2.h
+
+  @Summary
+    This is the generated header file for the TMR2 driver using PIC24 / dsPIC33 / PIC32MM MCUs
+
+  @Description
+    This header file provides APIs for driver for TMR2.
+    Generation Information :
+        Product Revision  :  PIC24 / dsPIC33 / PIC32MM MCUs - 1.125
+        Device            :  PIC24FJ128GA204
+    The generated drivers are tested against the following:
+        Compiler          :  XC16 v1.36B
+        MPLAB             :  MPLAB X v5.20
+*/
+/*
+    (c) 2016 Microchip Technology Inc. and its subsidiaries. You may use this
+    software and any derivatives exclusively with Microchip products.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+    WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+    PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION
+    WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+    BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+    FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+    ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+    THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+
+    MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE
+    TERMS.
+*/
+
+
+#ifndef _TMR2_H
+#define _TMR2_H
+
+/**
+  Section: Included Files
+*/
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+  Section: Interface Routines
+*/
+
+/**
+  @Summary
+    Initializes hardware and data for the given instance of the TMR module
+
+  @Description
+    This routine initializes hardware for the instance of the TMR module,
+    using the hardware initialization given data.  It also initializes all
+    necessary internal data.
+
+    TMR2 and TMR3 are chained into one 32-bit timer, which counts Fcy
+    (2 MHz) over the full 32-bit period, and interrupts through TMR3 when
+    it rolls over.
+
+  @Param
+    None.
+
+  @Returns
+    None
+
+  @Example
+    <code>
+    TMR2_Initialize();
+    </code>
+*/
+void TMR2_Initialize (void);
+
+/**
+  @Summary
+    Updates the TMR2 period value
+
+  @Description
+    This routine updates the TMR2 period value
+
+  @Param
+    value - 32-bit period value
+
+  @Returns
+    None
+*/
+void TMR2_Period32BitSet( uint32_t value );
+
+/**
+  @Summary
+    Provides the TMR2 period value
+
+  @Description
+    This routine provides the TMR2 period value
+
+  @Param
+    None.
+
+  @Returns
+    32-bit period value
+*/
+uint32_t TMR2_Period32BitGet( void );
+
+/**
+  @Summary
+    Updates the TMR2 counter value
+
+  @Description
+    This routine updates the TMR2 counter value
+
+  @Param
+    value - 32-bit counter value
+
+  @Returns
+    None
+*/
+void TMR2_Counter32BitSet ( uint32_t value );
+
+/**
+  @Summary
+    Provides the TMR2 counter value
+
+  @Description
+    This routine provides the TMR2 counter value. TMR2 is read first, which
+    latches TMR3 into TMR3HLD, so both halves are of the same instant.
+
+  @Param
+    None.
+
+  @Returns
+    32-bit counter value
+*/
+uint32_t TMR2_Counter32BitGet( void );
+
+/**
+  @Summary
+    Callback for TMR2 rollover
+
+  @Description
+    This routine is called from the TMR3 interrupt handler on every period
+    match of the 32-bit timer. The default implementation is empty and weakly linked; define it
+    elsewhere to handle the interrupt.
+
+  @Param
+    None.
+
+  @Returns
+    None
+*/
+void TMR2_CallBack(void);
+
+/**
+  @Summary
+    Starts the TMR
+
+  @Description
+    This routine starts the TMR
+
+  @Param
+    None.
+
+  @Returns
+    None
+*/
+void TMR2_Start( void );
+
+/**
+  @Summary
+    Stops the TMR
+
+  @Description
+    This routine stops the TMR
+
+  @Param
+    None.
+
+  @Returns
+    None
+*/
+void TMR2_Stop( void );
+
+#endif //_TMR2_H
+
+/**
+ End of File
+*/
@@ -0,0 +1,447 @@
+/* 
+ * File:     nmea.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include "nmea.h"
+
+// States of the framer
+#define FRAME_WAIT 0 // between sentences, waiting for '$'
+#define FRAME_BODY 1 // between '$' and '*'
+#define FRAME_HEX1 2 // expecting the high checksum digit
+#define FRAME_HEX2 3 // expecting the low checksum digit
+#define FRAME_END  4 // expecting "\r\n"
+
+/* Value of every char as a hex digit, with HEX_VALID set if it is one
+ * Any other char is 0, so a digit is decoded with a single lookup.
+ */
+#define HEX_VALID 0x10
+#define HEX_VALUE 0x0F
+
+static const uint8_t HEX_DIGITS[256] = {
+  ['0'] = HEX_VALID | 0x0, ['1'] = HEX_VALID | 0x1, ['2'] = HEX_VALID | 0x2,
+  ['3'] = HEX_VALID | 0x3, ['4'] = HEX_VALID | 0x4, ['5'] = HEX_VALID | 0x5,
+  ['6'] = HEX_VALID | 0x6, ['7'] = HEX_VALID | 0x7, ['8'] = HEX_VALID | 0x8,
+  ['9'] = HEX_VALID | 0x9,
+  ['A'] = HEX_VALID | 0xA, ['B'] = HEX_VALID | 0xB, ['C'] = HEX_VALID | 0xC,
+  ['D'] = HEX_VALID | 0xD, ['E'] = HEX_VALID | 0xE, ['F'] = HEX_VALID | 0xF,
+  ['a'] = HEX_VALID | 0xA, ['b'] = HEX_VALID | 0xB, ['c'] = HEX_VALID | 0xC,
+  ['d'] = HEX_VALID | 0xD, ['e'] = HEX_VALID | 0xE, ['f'] = HEX_VALID | 0xF
+};
+
+/**
+ * Drop the sentence in progress
+ * @param framer The framer
+ */
+static void nmea_framer_drop( nmea_framer_t *framer ) {
+  framer->dropped++;
+  framer->state = FRAME_WAIT;
+}
+
+/**
+ * End the field in progress at the char just appended, a ',' or the '*'
+ * @param sentence The sentence
+ */
+static void nmea_sentence_end_field( nmea_sentence_t *sentence ) {
+  nmea_span_t *span = &sentence->field[sentence->fieldCount - 1];
+  span->length = sentence->length - 1 - span->offset;
+}
+
+/**
+ * Add a char to the text of the sentence in progress
+ * @param framer The framer
+ * @param c The char to add
+ * @return 1 if it fit, 0 if the sentence was dropped
+ */
+static uint8_t nmea_framer_append( nmea_framer_t *framer, const uint8_t c ) {
+  
+  nmea_sentence_t *sentence = &framer->sentence;
+  
+  if( sentence->length == NMEA_MAX_LENGTH ) {
+    nmea_framer_drop( framer );
+    return 0;
+  }
+  
+  sentence->text[sentence->length++] = c;
+  return 1;
+}
+
+void nmea_framer_init( nmea_framer_t *framer, nmea_callback_t callback, void *context ) {
+  framer->state = FRAME_WAIT;
+  framer->dropped = 0;
+  framer->callback = callback;
+  framer->context = context;
+}
+
+void nmea_framer_push( nmea_framer_t *framer, const uint8_t c ) {
+  
+  nmea_sentence_t *sentence = &framer->sentence;
+  uint8_t digit;
+  
+  // a $ always begins a new sentence
+  if( c == '$' ) {
+    if( framer->state != FRAME_WAIT ) nmea_framer_drop( framer );
+    
+    sentence->text[0] = '$';
+    sentence->length = 1;
+    sentence->field[0].offset = 1;
+    sentence->field[0].length = 0;
+    sentence->fieldCount = 1;
+    framer->sum = 0;
+    framer->state = FRAME_BODY;
+    return;
+  }
+  
+  switch( framer->state ) {
+  case FRAME_BODY:
+    if( c == '*' ) {
+      if( !nmea_framer_append( framer, c ) ) return;
+      nmea_sentence_end_field( sentence );
+      framer->state = FRAME_HEX1;
+      return;
+    }
+    
+    // the checksum is mandatory here
+    if( c == '\r' || c == '\n' ) {
+      nmea_framer_drop( framer );
+      return;
+    }
+    
+    if( !nmea_framer_append( framer, c ) ) return;
+    framer->sum ^= c;
+    
+    // the next field starts right after the comma
+    if( c == ',' ) {
+      if( sentence->fieldCount == NMEA_MAX_FIELDS ) {
+        nmea_framer_drop( framer );
+        return;
+      }
+      nmea_sentence_end_field( sentence );
+      sentence->field[sentence->fieldCount].offset = sentence->length;
+      sentence->field[sentence->fieldCount].length = 0;
+      sentence->fieldCount++;
+    }
+    return;
+    
+  case FRAME_HEX1:
+  case FRAME_HEX2:
+    digit = HEX_DIGITS[c];
+    if( !digit ) {
+      nmea_framer_drop( framer );
+      return;
+    }
+    digit &= HEX_VALUE;
+    
+    if( !nmea_framer_append( framer, c ) ) return;
+    
+    if( framer->state == FRAME_HEX1 ) {
+      framer->checksum = digit << 4;
+      framer->state = FRAME_HEX2;
+    }
+    else {
+      framer->checksum |= digit;
+      framer->state = FRAME_END;
+    }
+    return;
+    
+  case FRAME_END:
+    if( c != '\r' && c != '\n' ) {
+      nmea_framer_drop( framer );
+      return;
+    }
+    
+    framer->state = FRAME_WAIT;
+    
+    if( framer->checksum != framer->sum ) {
+      framer->dropped++;
+      return;
+    }
+    
+    sentence->text[sentence->length] = 0;
+    if( framer->callback ) framer->callback( sentence, framer->context );
+    return;
+    
+  default:
+    // skip anything between sentences
+    return;
+  }
+}
+
+uint16_t nmea_framer_dropped( const nmea_framer_t *framer ) {
+  return framer->dropped;
+}
+
+/* Fields of the sentences that are decoded, counting the address field */
+#define GGA_TIME    1
+#define GGA_LAT     2
+#define GGA_NS      3
+#define GGA_LON     4
+#define GGA_EW      5
+#define GGA_QUALITY 6
+#define GGA_NUMSV   7
+#define GGA_HDOP    8
+#define GGA_ALT     9
+
+#define RMC_TIME    1
+#define RMC_STATUS  2
+#define RMC_LAT     3
+#define RMC_NS      4
+#define RMC_LON     5
+#define RMC_EW      6
+#define RMC_SPEED   7
+#define RMC_COURSE  8
+#define RMC_DATE    9
+
+nmea_field_t nmea_field( const nmea_sentence_t *sentence, const uint8_t index ) {
+  
+  nmea_field_t field;
+  
+  // a missing field reads as empty, at the terminator
+  if( index >= sentence->fieldCount ) {
+    field.text = sentence->text + sentence->length;
+    field.length = 0;
+    return field;
+  }
+  
+  field.text = sentence->text + sentence->field[index].offset;
+  field.length = sentence->field[index].length;
+  return field;
+}
+
+uint8_t nmea_field_fixed( const nmea_field_t field, uint8_t decimals, int32_t *value ) {
+  
+  const char *str = field.text;
+  const uint8_t len = field.length;
+  int32_t v = 0;
+  uint8_t negative = 0;
+  uint8_t point = 0;
+  uint8_t digits = 0;
+  uint8_t i = 0;
+  
+  if( len && str[0] == '-' ) {
+    negative = 1;
+    i++;
+  }
+  
+  for( ; i < len; i++ ) {
+    char c = str[i];
+    
+    if( c == '.' && !point ) {
+      point = 1;
+      continue;
+    }
+    if( c < '0' || c > '9' ) return 0;
+    
+    // keep only as many decimals as asked for
+    if( point ) {
+      if( !decimals ) continue;
+      decimals--;
+    }
+    
+    v = v * 10 + ( c - '0' );
+    digits++;
+  }
+  
+  if( !digits ) return 0;
+  
+  while( decimals-- ) v *= 10;
+  
+  *value = negative ? -v : v;
+  return 1;
+}
+
+/**
+ * Parse a latitude or longitude, given as [d]ddmm.mmmmm and a hemisphere
+ * @param angle The field of the angle
+ * @param hemisphere The field of the hemisphere, 'S' or 'W' being negative
+ * @param value Where the angle will be saved, in 1e-7 deg
+ * @return 1 if the angle was parsed, 0 otherwise
+ */
+static uint8_t nmea_parse_angle( const nmea_field_t angle, const nmea_field_t hemisphere, int32_t *value ) {
+  
+  int32_t v;
+  
+  // minutes to 5 decimals, with the degrees in front of them
+  if( !nmea_field_fixed( angle, 5, &v ) || v < 0 ) return 0;
+  
+  // split, then bring minutes (1e-5) to degrees (1e-7), rounding
+  int32_t degrees = v / 10000000L;
+  int32_t minutes = v % 10000000L;
+  v = degrees * 10000000L + ( minutes * 10 + 3 ) / 6;
+  
+  if( hemisphere.length != 1 ) return 0;
+  if( hemisphere.text[0] == 'S' || hemisphere.text[0] == 'W' ) v = -v;
+  
+  *value = v;
+  return 1;
+}
+
+/**
+ * Parse a UTC time, given as hhmmss.sss, into a fix
+ * @param time The field of the time
+ * @param fix The fix to update
+ */
+static void nmea_parse_time( const nmea_field_t time, gps_fix_t *fix ) {
+  
+  int32_t v;
+  
+  if( !nmea_field_fixed( time, 3, &v ) || v < 0 ) {
+    fix->valid &= ~FIX_VALID_TIME;
+    return;
+  }
+  
+  uint32_t seconds = v / 1000;
+  fix->millis = v % 1000;
+  fix->time = ( seconds / 10000 ) * 3600UL
+            + ( ( seconds / 100 ) % 100 ) * 60
+            + ( seconds % 100 );
+  fix->valid |= FIX_VALID_TIME;
+}
+
+/**
+ * Decode the fields of a GGA sentence
+ * @param sentence The sentence
+ * @param fix The fix to update
+ */
+static void nmea_decode_gga( const nmea_sentence_t *sentence, gps_fix_t *fix ) {
+  
+  nmea_field_t f;
+  int32_t lat, lon, v;
+  
+  nmea_parse_time( nmea_field( sentence, GGA_TIME ), fix );
+  
+  f = nmea_field( sentence, GGA_QUALITY );
+  fix->quality = ( f.length == 1 && f.text[0] >= '0' && f.text[0] <= '9' ) ? f.text[0] - '0' : 0;
+  
+  fix->numSV = nmea_field_fixed( nmea_field( sentence, GGA_NUMSV ), 0, &v ) ? (uint8_t)v : 0;
+  
+  // without a fix, the rest is meaningless
+  if( !fix->quality ) {
+    fix->valid &= ~( FIX_VALID_POSITION | FIX_VALID_ALTITUDE );
+    return;
+  }
+  
+  if( nmea_parse_angle( nmea_field( sentence, GGA_LAT ), nmea_field( sentence, GGA_NS ), &lat )
+      && nmea_parse_angle( nmea_field( sentence, GGA_LON ), nmea_field( sentence, GGA_EW ), &lon ) ) {
+    fix->lat = lat;
+    fix->lon = lon;
+    fix->valid |= FIX_VALID_POSITION;
+  }
+  else fix->valid &= ~FIX_VALID_POSITION;
+  
+  if( nmea_field_fixed( nmea_field( sentence, GGA_HDOP ), 2, &v ) ) fix->hdop = (uint16_t)v;
+  
+  // meters, to mm
+  if( nmea_field_fixed( nmea_field( sentence, GGA_ALT ), 3, &v ) ) {
+    fix->alt = v;
+    fix->valid |= FIX_VALID_ALTITUDE;
+  }
+  else fix->valid &= ~FIX_VALID_ALTITUDE;
+}
+
+/**
+ * Decode the fields of an RMC sentence
+ * @param sentence The sentence
+ * @param fix The fix to update
+ */
+static void nmea_decode_rmc( const nmea_sentence_t *sentence, gps_fix_t *fix ) {
+  
+  nmea_field_t f;
+  int32_t lat, lon, v;
+  
+  nmea_parse_time( nmea_field( sentence, RMC_TIME ), fix );
+  
+  // ddmmyy
+  f = nmea_field( sentence, RMC_DATE );
+  if( f.length == 6 && nmea_field_fixed( f, 0, &v ) ) {
+    fix->day = v / 10000;
+    fix->month = ( v / 100 ) % 100;
+    fix->year = 2000 + v % 100;
+    fix->valid |= FIX_VALID_DATE;
+  }
+  else fix->valid &= ~FIX_VALID_DATE;
+  
+  // a void status means the rest is meaningless
+  f = nmea_field( sentence, RMC_STATUS );
+  if( f.length != 1 || f.text[0] != 'A' ) {
+    fix->valid &= ~( FIX_VALID_POSITION | FIX_VALID_VELOCITY );
+    return;
+  }
+  
+  if( nmea_parse_angle( nmea_field( sentence, RMC_LAT ), nmea_field( sentence, RMC_NS ), &lat )
+      && nmea_parse_angle( nmea_field( sentence, RMC_LON ), nmea_field( sentence, RMC_EW ), &lon ) ) {
+    fix->lat = lat;
+    fix->lon = lon;
+    fix->valid |= FIX_VALID_POSITION;
+  }
+  else fix->valid &= ~FIX_VALID_POSITION;
+  
+  // knots (1e-3) to mm/s: 1 knot is 463/900 m/s, split to avoid overflow
+  if( !nmea_field_fixed( nmea_field( sentence, RMC_SPEED ), 3, &v ) || v < 0 ) {
+    fix->valid &= ~FIX_VALID_VELOCITY;
+    return;
+  }
+  fix->speed = ( v / 900 ) * 463 + ( ( v % 900 ) * 463 ) / 900;
+  
+  // the course is empty while not moving
+  fix->course = nmea_field_fixed( nmea_field( sentence, RMC_COURSE ), 2, &v ) ? (uint16_t)v : 0;
+  
+  fix->valid |= FIX_VALID_VELOCITY;
+}
+
+uint8_t nmea_decode( const nmea_sentence_t *sentence, gps_fix_t *fix ) {
+  
+  if( nmea_is( sentence, "GGA" ) ) {
+    nmea_decode_gga( sentence, fix );
+    return 1;
+  }
+  
+  if( nmea_is( sentence, "RMC" ) ) {
+    nmea_decode_rmc( sentence, fix );
+    return 1;
+  }
+  
+  return 0;
+}
+
+uint8_t nmea_is( const nmea_sentence_t *sentence, const char *name ) {
+  
+  // the address is a 2-char talker (GP, GN, ...) then the sentence name
+  nmea_field_t f = nmea_field( sentence, 0 );
+  if( f.length != 5 ) return 0;
+  
+  return f.text[2] == name[0] && f.text[3] == name[1] && f.text[4] == name[2];
+}
+
+uint8_t nmea_checksum_matches( const char *hex, const uint8_t sum ) {
+  
+  uint8_t high = HEX_DIGITS[(uint8_t)hex[0]];
+  uint8_t low;
+  
+  // stop at the terminator, rather than reading past it
+  if( !high ) return 0;
+  low = HEX_DIGITS[(uint8_t)hex[1]];
+  
+  return ( low & HEX_VALID ) && ( ( ( high & HEX_VALUE ) << 4 ) | ( low & HEX_VALUE ) ) == sum;
+}
+
+uint8_t nmea_validate( const char *sentence ) {
+  
+  uint8_t sum = 0;
+  uint8_t i;
+  
+  //all NMEA sentences start with $
+  if( sentence[0] != '$' ) return 0;
+  
+  //the checksum covers everything between '$' and '*', which must come
+  //within the longest sentence, so a missing '*' cannot run on
+  for( i = 1; i < NMEA_MAX_LENGTH && sentence[i] != '*'; i++ ) {
+    if( sentence[i] == 0 ) return 0;
+    sum ^= sentence[i];
+  }
+  if( sentence[i] != '*' ) return 0;
+  
+  //compare with the two hex digits after the '*'
+  return nmea_checksum_matches( sentence + i + 1, sum );
+}
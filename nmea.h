@@ -0,0 +1,230 @@
+/* 
+ * File:     nmea.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef NMEA_H
+#define	NMEA_H
+
+#include <stdint.h>
+#include "gps_fix.h"
+
+/*
+ * NMEA sentences arrive from the GPS as a stream of chars, which may be cut
+ * anywhere by the reads that bring them in. The framer below takes that
+ * stream one char at a time and hands back each complete, valid sentence:
+ * 
+ *   '$'        starts a new sentence, dropping any unfinished one
+ *   ','        ends a field; where it lies in the sentence is recorded
+ *   '*'        ends the body; two hex digits of checksum must follow
+ *   '\r', '\n' ends the sentence, which is delivered if the checksum matches
+ * 
+ * The checksum is the running XOR of every char between '$' and '*', which
+ * is accumulated as the chars go by, so a sentence is never scanned twice.
+ * 
+ * Reference: NMEA 0183, and u-blox M8 Receiver Description
+ *            31.2 "NMEA Protocol Overview", pg. 105
+ */
+
+// Longest NMEA sentence, including '$' and checksum but not "\r\n"
+#define NMEA_MAX_LENGTH 82
+
+// Most fields in a sentence, counting the address field (e.g. "GPGGA")
+#define NMEA_MAX_FIELDS 24
+
+/*
+ * Where a field lies in the text of its sentence.
+ */
+typedef struct {
+  uint8_t offset;
+  uint8_t length;
+} nmea_span_t;
+
+/*
+ * A sentence delivered by the framer.
+ * 
+ * text holds everything from '$' up to the last checksum digit, and is
+ * null-terminated. field[i] is where the i-th field lies in text, not
+ * counting its ',' or '*', where field 0 is the address field right after
+ * '$'. The framer records these as the chars go by, so a sentence never
+ * needs to be tokenized again.
+ */
+typedef struct {
+  char        text[NMEA_MAX_LENGTH + 1];
+  uint8_t     length;
+  uint8_t     fieldCount;
+  nmea_span_t field[NMEA_MAX_FIELDS];
+} nmea_sentence_t;
+
+/*
+ * A view of a field, into the text of its sentence. The text is not
+ * null-terminated, but followed by the ',' or '*' that ends the field.
+ */
+typedef struct {
+  const char *text;
+  uint8_t     length;
+} nmea_field_t;
+
+/*
+ * Called by the framer for every complete, valid sentence.
+ * The sentence is only valid until the next char is pushed.
+ */
+typedef void (*nmea_callback_t)( const nmea_sentence_t *sentence, void *context );
+
+/*
+ * The state of a framer. Its fields are private to nmea.c.
+ */
+typedef struct {
+  nmea_sentence_t sentence;
+  uint8_t         state;
+  uint8_t         sum;
+  uint8_t         checksum;
+  uint16_t        dropped;
+  nmea_callback_t callback;
+  void           *context;
+} nmea_framer_t;
+
+/**
+ * Initialize a framer.
+ * 
+ * Precondition:
+ *   framer must be a valid memory address.
+ * 
+ * Postcondition:
+ *   The framer waits for the '$' of the next sentence.
+ * 
+ * @param framer The framer to initialize
+ * @param callback The function called with every valid sentence
+ * @param context A pointer passed back to the callback
+ */
+void nmea_framer_init( nmea_framer_t *framer, nmea_callback_t callback, void *context );
+
+/**
+ * Push the next char of the stream into a framer.
+ * 
+ * Precondition:
+ *   framer must be initialized.
+ * 
+ * Postcondition:
+ *   If c completes a valid sentence, the callback has been called with it.
+ * 
+ * @param framer The framer
+ * @param c The next char of the stream
+ */
+void nmea_framer_push( nmea_framer_t *framer, const uint8_t c );
+
+/**
+ * Count the sentences a framer has dropped.
+ * 
+ * Sentences are dropped when they are too long, have too many fields,
+ * are missing their checksum, or their checksum does not match.
+ * 
+ * @param framer The framer
+ * @return The number of sentences dropped since initialization
+ */
+uint16_t nmea_framer_dropped( const nmea_framer_t *framer );
+
+/**
+ * Get a field of a sentence, without copying it
+ * 
+ * Precondition:
+ *   sentence was delivered by a framer.
+ * 
+ * Postcondition:
+ *   The view is only valid as long as the sentence is.
+ * 
+ * @param sentence The sentence
+ * @param index The index of the field, 0 being the address field
+ * @return A view of the field, empty if it is empty or missing
+ */
+nmea_field_t nmea_field( const nmea_sentence_t *sentence, const uint8_t index );
+
+/**
+ * Parse a field holding a decimal number as a fixed-point integer
+ * 
+ * Digits beyond the given number of decimals are dropped, and missing
+ * ones are taken as 0, so "12.3" with 3 decimals gives 12300.
+ * 
+ * Precondition:
+ *   field came from nmea_field.
+ * 
+ * Postcondition:
+ *   value is unchanged if the field could not be parsed.
+ * 
+ * @param field The field
+ * @param decimals The number of decimal places of the result
+ * @param value Where the result will be saved
+ * @return 1 if the number was parsed, 0 if it is empty or malformed
+ */
+uint8_t nmea_field_fixed( const nmea_field_t field, uint8_t decimals, int32_t *value );
+
+/**
+ * Check the name of a sentence, whatever its talker
+ * 
+ * Precondition:
+ *   sentence was delivered by a framer.
+ *   name holds at least 3 chars.
+ * 
+ * Postcondition:
+ *   None.
+ * 
+ * @param sentence The sentence
+ * @param name The sentence name, e.g. "GGA"
+ * @return 1 if the address field is a talker followed by name, 0 otherwise
+ */
+uint8_t nmea_is( const nmea_sentence_t *sentence, const char *name );
+
+/**
+ * Decode a GGA or RMC sentence into a fix, using integer math only.
+ * 
+ * Only the parts of the fix carried by the sentence are changed, so GGA
+ * and RMC from the same epoch can be merged by decoding both into the
+ * same fix. A GGA without a fix, or an RMC with a void status, clears the
+ * flags of the parts it would have carried.
+ * 
+ * Precondition:
+ *   sentence was delivered by a framer.
+ * 
+ * Postcondition:
+ *   fix->valid flags the parts of the fix that are current.
+ * 
+ * @param sentence The sentence to decode
+ * @param fix The fix to update
+ * @return 1 if the sentence was GGA or RMC, 0 otherwise
+ */
+uint8_t nmea_decode( const nmea_sentence_t *sentence, gps_fix_t *fix );
+
+/**
+ * Compares two hex digits with a checksum
+ * 
+ * Precondition:
+ *   hex must point to a null-terminated string.
+ * 
+ * Postcondition:
+ *   Nothing past the terminator of hex is read.
+ * 
+ * @param hex The digits, most significant first, in either case
+ * @param sum The checksum they should match
+ * @return 1 if both are hex digits and match sum, 0 otherwise
+ */
+uint8_t nmea_checksum_matches( const char *hex, const uint8_t sum );
+
+/**
+ * Validates an NMEA sentence.
+ * 
+ * The '*' must come within NMEA_MAX_LENGTH chars, so a malformed sentence
+ * is rejected in bounded time.
+ * 
+ * Precondition:
+ *   sentence must point to a null-terminated string.
+ * 
+ * Postcondition:
+ *   None.
+ * 
+ * @param sentence The string to validate.
+ * @return 1 if the sentence is valid, 0 otherwise
+ */
+uint8_t nmea_validate( const char *sentence );
+
+#endif	/* NMEA_H */
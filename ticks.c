@@ -0,0 +1,55 @@
+/* 
+ * File:     ticks.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include <xc.h>
+#include "ticks.h"
+#include "mcc_generated_files/tmr2.h"
+
+// Wraps of the timebase, counted in the Timer3 interrupt
+static volatile uint32_t wraps = 0;
+
+void TMR2_CallBack( void ) {
+  wraps++;
+}
+
+ticks_t now_ticks( void ) {
+  
+  uint16_t low, high;
+  
+  // reading TMR2 latches TMR3 into TMR3HLD, so an interrupt that reads the
+  // timer between the two halves would change the upper one
+  __builtin_disi( 0x3FFF );
+  low = TMR2;
+  high = TMR3HLD;
+  DISICNT = 0;
+  
+  return ( (ticks_t)high << 16 ) | low;
+}
+
+uint64_t now_ticks_wide( void ) {
+  
+  ticks_t count;
+  uint32_t high;
+  uint16_t enabled = IEC0bits.T3IE;
+  
+  IEC0bits.T3IE = 0;
+  count = now_ticks();
+  high = wraps;
+  
+  // a wrap that is still pending came before a small count
+  if( IFS0bits.T3IF && count < 0x80000000UL ) high++;
+  IEC0bits.T3IE = enabled;
+  
+  return ( (uint64_t)high << 32 ) | count;
+}
+
+ticks_t ticks_since( const ticks_t start ) {
+  return now_ticks() - start;
+}
+
+uint32_t ticks_to_us( const ticks_t ticks ) {
+  return ticks / TICKS_PER_US;
+}
@@ -0,0 +1,63 @@
+/* 
+ * File:     ticks.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef TICKS_H
+#define	TICKS_H
+
+#include <stdint.h>
+#include "mcc_generated_files/clock.h"
+
+/*
+ * Timer2 and Timer3 are chained into a 32-bit timer that counts every
+ * instruction cycle, so a tick is 0.5 us at Fcy = 2 MHz. It runs freely
+ * from SYSTEM_Initialize, and is never stopped or reloaded.
+ * 
+ * now_ticks reads it in a few instructions, masking interrupts only while
+ * it reads the two halves, so it is cheap and safe anywhere, including
+ * interrupts. The count wraps about every 35 minutes, but the difference
+ * of two readings, taken as a ticks_t, is right across a wrap as long as
+ * they are less than that apart:
+ * 
+ *   ticks_t start = now_ticks();
+ *   lora_init();
+ *   uint32_t us = ticks_to_us( ticks_since( start ) );
+ * 
+ * now_ticks_wide extends the count with the wraps counted in the Timer3
+ * interrupt, for spans longer than that.
+ */
+
+typedef uint32_t ticks_t;
+
+/* Ticks in a microsecond */
+#define TICKS_PER_US ( CLOCK_InstructionFrequencyGet() / 1000000UL )
+
+/**
+ * Read the timebase
+ * @return The ticks since startup, modulo 2^32
+ */
+ticks_t now_ticks( void );
+
+/**
+ * Read the timebase, extended so it never wraps
+ * @return The ticks since startup
+ */
+uint64_t now_ticks_wide( void );
+
+/**
+ * Measure the ticks since an earlier reading
+ * @param start An earlier reading of now_ticks
+ * @return The ticks since start, right across a wrap of the timebase
+ */
+ticks_t ticks_since( const ticks_t start );
+
+/**
+ * Convert ticks to microseconds
+ * @param ticks The ticks
+ * @return The microseconds, rounded down
+ */
+uint32_t ticks_to_us( const ticks_t ticks );
+
+#endif	/* TICKS_H */
@@ -0,0 +1,319 @@
+/* 
+ * File:     timekeeping.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include <xc.h>
+#include <stddef.h>
+#include <time.h>
+#include "timekeeping.h"
+#include "mcc_generated_files/tmr1.h"
+#include "mcc_generated_files/ic1.h"
+#include "mcc_generated_files/rtcc.h"
+
+// The rate is kept in 1/RATE_SCALE ticks per second
+#define RATE_SCALE 16
+
+// Each timepulse moves the rate 1/RATE_WEIGHT of the way to what it measured
+#define RATE_WEIGHT 8
+
+// A second between timepulses may be this many ticks from nominal
+#define RATE_TOLERANCE ( TIMEKEEPING_TICKS_PER_SECOND / 32 )
+
+// A worse source may not replace a reference younger than this, in us
+#define HOLDOVER 60000000ULL
+
+#define MICROS_PER_SECOND 1000000UL
+#define SECONDS_PER_DAY   86400UL
+
+// Days before each month of a common year
+static const uint16_t DAYS_BEFORE[12] = {
+  0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+// Written by the TMR1 and IC1 interrupts
+static volatile uint32_t overflows = 0;
+static volatile uint64_t ppsTicks = 0;
+static volatile uint32_t ppsInterval = 0;
+static volatile uint16_t ppsCount = 0;
+
+// The clock was baseMicros at baseTicks, and runs at rate from there
+static uint32_t rate = TIMEKEEPING_TICKS_PER_SECOND * RATE_SCALE;
+static uint8_t  rateMeasured = 0;
+static uint64_t baseTicks = 0;
+static uint64_t baseMicros = 0;
+static uint16_t ppsSeen = 0;
+
+// UTC was refSeconds when the clock was refMicros
+static uint32_t refSeconds = 0;
+static uint64_t refMicros = 0;
+static uint8_t  refSource = TIME_SOURCE_NONE;
+
+/**
+ * Extend a count of Timer1 with its overflows
+ * 
+ * Precondition:
+ *   The TMR1 interrupt must not run, either because it is masked or
+ *   because this is called from an interrupt of the same priority.
+ * 
+ * @param count Timer1, read or captured no more than half an overflow ago
+ * @return The ticks since startup at count
+ */
+static uint64_t timekeeping_extend( const uint16_t count ) {
+  
+  uint32_t high = overflows;
+  
+  // an overflow that is still pending came before a small count
+  if( IFS0bits.T1IF && count < 0x8000 ) high++;
+  
+  return ( (uint64_t)high << 16 ) | count;
+}
+
+void TMR1_CallBack( void ) {
+  overflows++;
+}
+
+/*
+ * IC1 comes before TMR1 in the natural order of the interrupts, so an edge
+ * captured just before an overflow is always extended before the overflow
+ * is counted.
+ */
+void IC1_CallBack( void ) {
+  
+  uint64_t edge = 0;
+  uint8_t captured = 0;
+  
+  // only the latest edge matters
+  while( !IC1_IsCaptureBufferEmpty() ) {
+    edge = timekeeping_extend( IC1_CaptureDataRead() );
+    captured = 1;
+  }
+  if( !captured ) return;
+  
+  ppsInterval = ( ppsTicks ) ? (uint32_t)( edge - ppsTicks ) : 0;
+  ppsTicks = edge;
+  ppsCount++;
+}
+
+uint64_t timekeeping_ticks( void ) {
+  
+  uint64_t ticks;
+  uint16_t enabled = IEC0bits.T1IE;
+  
+  IEC0bits.T1IE = 0;
+  ticks = timekeeping_extend( TMR1_Counter16BitGet() );
+  IEC0bits.T1IE = enabled;
+  
+  return ticks;
+}
+
+/**
+ * Convert ticks to the disciplined clock
+ * @param ticks Ticks since startup, before or after the base
+ * @return Microseconds since startup
+ */
+static uint64_t timekeeping_micros_at( const uint64_t ticks ) {
+  
+  const uint64_t scale = (uint64_t)MICROS_PER_SECOND * RATE_SCALE;
+  
+  if( ticks >= baseTicks ) return baseMicros + ( ticks - baseTicks ) * scale / rate;
+  return baseMicros - ( baseTicks - ticks ) * scale / rate;
+}
+
+uint64_t timekeeping_micros( void ) {
+  return timekeeping_micros_at( timekeeping_ticks() );
+}
+
+/**
+ * Follow the timepulses captured since the last call
+ * @param edge Where the latest edge will be saved
+ * @param edges Where the count of edges captured so far will be saved
+ * @return 1 if there was a new edge, 0 otherwise
+ */
+static uint8_t timekeeping_discipline( uint64_t *edge, uint16_t *edges ) {
+  
+  uint16_t count;
+  uint32_t interval;
+  uint64_t now;
+  
+  IEC0bits.IC1IE = 0;
+  count = ppsCount;
+  *edges = count;
+  interval = ppsInterval;
+  *edge = ppsTicks;
+  IEC0bits.IC1IE = 1;
+  
+  if( count == ppsSeen ) return 0;
+  ppsSeen = count;
+  
+  // the timepulse stops without a fix, so the first one after is not a second
+  if( interval < TIMEKEEPING_TICKS_PER_SECOND - RATE_TOLERANCE ) return 1;
+  if( interval > TIMEKEEPING_TICKS_PER_SECOND + RATE_TOLERANCE ) return 1;
+  
+  // rebase, so the new rate does not apply to the past
+  now = timekeeping_ticks();
+  baseMicros = timekeeping_micros_at( now );
+  baseTicks = now;
+  
+  interval *= RATE_SCALE;
+  if( !rateMeasured ) rate = interval;
+  else if( interval > rate ) rate += ( interval - rate ) / RATE_WEIGHT;
+  else rate -= ( rate - interval ) / RATE_WEIGHT;
+  rateMeasured = 1;
+  
+  return 1;
+}
+
+/**
+ * Count the days since 1 January 2000
+ * @param year The year, from 2000
+ * @param month The month, from 1
+ * @param day The day of the month, from 1
+ * @return The days before the date
+ */
+static uint32_t timekeeping_days( const uint16_t year, const uint8_t month, const uint8_t day ) {
+  
+  uint16_t y = year - 2000;
+  uint32_t days = 365UL * y + ( y + 3 ) / 4 + DAYS_BEFORE[month - 1] + day - 1;
+  
+  if( month > 2 && y % 4 == 0 ) days++;
+  return days;
+}
+
+/**
+ * Convert seconds since 1 January 2000 to a date, as the RTCC keeps it
+ * @param seconds The seconds
+ * @param date Where the date will be saved
+ */
+static void timekeeping_date( const uint32_t seconds, struct tm *date ) {
+  
+  uint32_t days = seconds / SECONDS_PER_DAY;
+  uint32_t rest = seconds % SECONDS_PER_DAY;
+  uint16_t y = 0, length, before;
+  uint8_t m = 12;
+  
+  date->tm_hour = rest / 3600;
+  date->tm_min = ( rest / 60 ) % 60;
+  date->tm_sec = rest % 60;
+  
+  // 1 January 2000 was a Saturday
+  date->tm_wday = ( days + 6 ) % 7;
+  
+  while( days >= ( length = ( y % 4 ) ? 365 : 366 ) ) {
+    days -= length;
+    y++;
+  }
+  
+  do {
+    before = DAYS_BEFORE[m - 1] + ( m > 2 && y % 4 == 0 );
+  } while( before > days && --m );
+  
+  date->tm_year = y;
+  date->tm_mon = m;
+  date->tm_mday = days - before + 1;
+}
+
+/**
+ * Convert a date, as the RTCC keeps it, to seconds since 1 January 2000
+ * @param date The date
+ * @param seconds Where the seconds will be saved
+ * @return 1 if the date holds a time, 0 if it was never set
+ */
+static uint8_t timekeeping_seconds( const struct tm *date, uint32_t *seconds ) {
+  
+  if( date->tm_year < 1 || date->tm_year > 99 ) return 0;
+  if( date->tm_mon < 1 || date->tm_mon > 12 ) return 0;
+  if( date->tm_mday < 1 || date->tm_mday > 31 ) return 0;
+  
+  *seconds = timekeeping_days( 2000 + date->tm_year, date->tm_mon, date->tm_mday ) * SECONDS_PER_DAY
+      + date->tm_hour * 3600UL + date->tm_min * 60UL + date->tm_sec;
+  return 1;
+}
+
+/**
+ * Set the RTCC if it is more than a second from UTC
+ */
+static void timekeeping_sync_rtcc( void ) {
+  
+  struct tm date;
+  time_utc_t now;
+  uint32_t held;
+  
+  // the RTCC is rolling over, and is checked again with the next fix
+  if( !RTCC_TimeGet( &date ) ) return;
+  
+  timekeeping_utc( &now );
+  if( timekeeping_seconds( &date, &held ) && held + 1 >= now.seconds && held <= now.seconds + 1 ) return;
+  
+  timekeeping_date( now.seconds, &date );
+  RTCC_TimeSet( &date );
+}
+
+void timekeeping_init( void ) {
+  
+  struct tm date;
+  
+  if( !RTCC_TimeGet( &date ) && !RTCC_TimeGet( &date ) ) return;
+  if( !timekeeping_seconds( &date, &refSeconds ) ) return;
+  
+  refMicros = timekeeping_micros();
+  refSource = TIME_SOURCE_RTCC;
+}
+
+void timekeeping_update( const gps_fix_t *fix ) {
+  
+  static uint64_t edge = 0;
+  static uint16_t fixEdges = 0;
+  uint8_t source = TIME_SOURCE_FIX;
+  uint64_t now, at;
+  uint32_t seconds;
+  uint16_t edges;
+  uint8_t sinceFix;
+  
+  timekeeping_discipline( &edge, &edges );
+  
+  if( !fix ) return;
+  
+  // edges captured since the fix before this one was taken
+  sinceFix = ( edges - fixEdges == 1 );
+  fixEdges = edges;
+
+  if( ( fix->valid & ( FIX_VALID_TIME | FIX_VALID_DATE ) ) != ( FIX_VALID_TIME | FIX_VALID_DATE ) ) return;
+  if( fix->year < 2000 || fix->month < 1 || fix->month > 12 || fix->day < 1 ) return;
+  
+  now = timekeeping_ticks();
+  at = timekeeping_micros_at( now ) - fix->millis * 1000UL;
+  
+  // the output of an epoch ends well within its second, so the edge began
+  // the second of a fix of a whole second if it is less than a second old
+  // and the only one since the fix before. A fix that arrives late, after
+  // the next edge, or after fixes were missed, is taken as it arrived
+  if( !fix->millis && sinceFix && edge && now - edge < rate / RATE_SCALE ) {
+    at = timekeeping_micros_at( edge );
+    source = TIME_SOURCE_PPS;
+  }
+  
+  // a worse source only takes over once the last reference grows old
+  if( source < refSource && at - refMicros < HOLDOVER ) return;
+  
+  seconds = timekeeping_days( fix->year, fix->month, fix->day ) * SECONDS_PER_DAY + fix->time;
+  refSeconds = seconds;
+  refMicros = at;
+  refSource = source;
+  
+  timekeeping_sync_rtcc();
+}
+
+uint8_t timekeeping_utc( time_utc_t *now ) {
+  
+  uint64_t elapsed;
+  
+  if( refSource == TIME_SOURCE_NONE ) return TIME_SOURCE_NONE;
+  
+  elapsed = timekeeping_micros() - refMicros;
+  now->seconds = refSeconds + (uint32_t)( elapsed / MICROS_PER_SECOND );
+  now->micros = (uint32_t)( elapsed % MICROS_PER_SECOND );
+  
+  return refSource;
+}
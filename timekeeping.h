@@ -0,0 +1,104 @@
+/* 
+ * File:     timekeeping.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef TIMEKEEPING_H
+#define	TIMEKEEPING_H
+
+#include <stdint.h>
+#include "gps_fix.h"
+
+/*
+ * Timer1 counts Fcy / 64 = 31250 ticks per second, and its interrupt counts
+ * its overflows, which together make a count of ticks that never wraps.
+ * The GPS timepulse on RB6 rises at the top of every UTC second while the
+ * GPS has a fix, and IC1 captures Timer1 at that edge, so the edge is known
+ * to a tick however late its interrupt runs.
+ * 
+ * The ticks come from the FRC, which is only good to a couple of percent.
+ * The ticks between two timepulses measure how many there really are in a
+ * second, and the clock is disciplined to that rate. A new rate only ever
+ * applies from the moment it is measured, so the clock stays monotonic.
+ * 
+ * UTC comes from the time and date of a fix. The timepulse before a fix of
+ * a whole second marks exactly when that second began, as long as it is
+ * the only one since the fix before, so it cannot belong to a later
+ * second; any other fix is only as good as the time it took to arrive. The RTCC is set from UTC, and
+ * provides the time after a reset until the GPS does again.
+ * 
+ * Dates are counted from 1 January 2000, and are correct until 2099.
+ */
+
+/* Where the current UTC came from, from worst to best */
+#define TIME_SOURCE_NONE 0
+#define TIME_SOURCE_RTCC 1 // the RTCC, to a second
+#define TIME_SOURCE_FIX  2 // a fix, as it arrived
+#define TIME_SOURCE_PPS  3 // a fix, at the timepulse
+
+/* Nominal ticks of the timebase in a second */
+#define TIMEKEEPING_TICKS_PER_SECOND 31250UL
+
+/*
+ * A UTC time
+ */
+typedef struct {
+  uint32_t seconds; // since 1 January 2000
+  uint32_t micros;  // within the second
+} time_utc_t;
+
+/**
+ * Initialize timekeeping
+ * 
+ * Precondition:
+ *   SYSTEM_Initialize must have started TMR1, IC1 and the RTCC.
+ * 
+ * Postcondition:
+ *   UTC is taken from the RTCC if it holds a date.
+ */
+void timekeeping_init( void );
+
+/**
+ * Discipline the clock, and take UTC from a fix
+ * 
+ * Meant to be called with every fix from gps_get_fix, and regularly
+ * without one, so the rate follows every timepulse.
+ * 
+ * Precondition:
+ *   Timekeeping must be initialized.
+ * 
+ * Postcondition:
+ *   The rate follows the timepulses captured since the last call.
+ *   With a time and date, the fix is the new reference for UTC, unless it
+ *     is worse than a recent one.
+ *   The RTCC is set if it is more than a second from UTC.
+ * 
+ * @param fix The latest fix, or NULL
+ */
+void timekeeping_update( const gps_fix_t *fix );
+
+/**
+ * Get the raw timebase, safe to call from an interrupt
+ * @return Ticks since startup
+ */
+uint64_t timekeeping_ticks( void );
+
+/**
+ * Get the disciplined, monotonic clock
+ * @return Microseconds since startup
+ */
+uint64_t timekeeping_micros( void );
+
+/**
+ * Get the current UTC
+ * 
+ * Precondition:
+ *   Timekeeping must be initialized.
+ * 
+ * @param now Where the time will be saved
+ * @return The TIME_SOURCE_* it came from, TIME_SOURCE_NONE if there is none
+ */
+uint8_t timekeeping_utc( time_utc_t *now );
+
+#endif	/* TIMEKEEPING_H */
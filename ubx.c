@@ -0,0 +1,222 @@
+/* 
+ * File:     ubx.c
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#include "ubx.h"
+
+// States of the parser
+#define PARSE_SYNC_1  0
+#define PARSE_SYNC_2  1
+#define PARSE_CLASS   2
+#define PARSE_ID      3
+#define PARSE_LEN_1   4
+#define PARSE_LEN_2   5
+#define PARSE_PAYLOAD 6
+#define PARSE_CK_A    7
+#define PARSE_CK_B    8
+
+uint16_t ubx_u2( const uint8_t *p ) {
+  return (uint16_t)p[0] | ( (uint16_t)p[1] << 8 );
+}
+
+uint32_t ubx_u4( const uint8_t *p ) {
+  return (uint32_t)ubx_u2( p ) | ( (uint32_t)ubx_u2( p + 2 ) << 16 );
+}
+
+uint16_t ubx_build( uint8_t *buffer, const uint8_t msgClass, const uint8_t msgId,
+                    const uint8_t *payload, const uint16_t length ) {
+  
+  uint8_t ckA = 0;
+  uint8_t ckB = 0;
+  uint16_t i;
+  
+  buffer[0] = UBX_SYNC_1;
+  buffer[1] = UBX_SYNC_2;
+  buffer[2] = msgClass;
+  buffer[3] = msgId;
+  buffer[4] = (uint8_t)length;
+  buffer[5] = (uint8_t)( length >> 8 );
+  for( i = 0; i < length; i++ ) buffer[6 + i] = payload[i];
+  
+  // the checksum covers everything after the sync chars
+  for( i = 2; i < length + 6; i++ ) {
+    ckA += buffer[i];
+    ckB += ckA;
+  }
+  
+  buffer[length + 6] = ckA;
+  buffer[length + 7] = ckB;
+  
+  return length + UBX_OVERHEAD;
+}
+
+void ubx_parser_init( ubx_parser_t *parser, ubx_callback_t callback, void *context ) {
+  parser->state = PARSE_SYNC_1;
+  parser->dropped = 0;
+  parser->callback = callback;
+  parser->context = context;
+}
+
+void ubx_parser_push( ubx_parser_t *parser, const uint8_t b ) {
+  
+  ubx_frame_t *frame = &parser->frame;
+  
+  // everything between the sync chars and the checksum is summed
+  if( parser->state >= PARSE_CLASS && parser->state <= PARSE_PAYLOAD ) {
+    parser->ckA += b;
+    parser->ckB += parser->ckA;
+  }
+  
+  switch( parser->state ) {
+  case PARSE_SYNC_1:
+    if( b == UBX_SYNC_1 ) parser->state = PARSE_SYNC_2;
+    return;
+    
+  case PARSE_SYNC_2:
+    if( b == UBX_SYNC_2 ) {
+      parser->ckA = 0;
+      parser->ckB = 0;
+      parser->state = PARSE_CLASS;
+    }
+    else {
+      // the first sync char may repeat
+      parser->state = ( b == UBX_SYNC_1 ) ? PARSE_SYNC_2 : PARSE_SYNC_1;
+    }
+    return;
+    
+  case PARSE_CLASS:
+    frame->msgClass = b;
+    parser->state = PARSE_ID;
+    return;
+    
+  case PARSE_ID:
+    frame->msgId = b;
+    parser->state = PARSE_LEN_1;
+    return;
+    
+  case PARSE_LEN_1:
+    frame->length = b;
+    parser->state = PARSE_LEN_2;
+    return;
+    
+  case PARSE_LEN_2:
+    frame->length |= (uint16_t)b << 8;
+    if( frame->length > UBX_MAX_PAYLOAD ) {
+      parser->dropped++;
+      parser->state = PARSE_SYNC_1;
+      return;
+    }
+    parser->index = 0;
+    parser->state = frame->length ? PARSE_PAYLOAD : PARSE_CK_A;
+    return;
+    
+  case PARSE_PAYLOAD:
+    frame->payload[parser->index++] = b;
+    if( parser->index == frame->length ) parser->state = PARSE_CK_A;
+    return;
+    
+  case PARSE_CK_A:
+    if( b != parser->ckA ) {
+      parser->dropped++;
+      parser->state = PARSE_SYNC_1;
+      return;
+    }
+    parser->state = PARSE_CK_B;
+    return;
+    
+  case PARSE_CK_B:
+    parser->state = PARSE_SYNC_1;
+    if( b != parser->ckB ) {
+      parser->dropped++;
+      return;
+    }
+    if( parser->callback ) parser->callback( frame, parser->context );
+    return;
+    
+  default:
+    parser->state = PARSE_SYNC_1;
+    return;
+  }
+}
+
+uint16_t ubx_parser_dropped( const ubx_parser_t *parser ) {
+  return parser->dropped;
+}
+
+uint8_t ubx_decode_nav_pvt( const ubx_frame_t *frame, ubx_nav_pvt_t *pvt ) {
+  
+  const uint8_t *p = frame->payload;
+  
+  if( frame->msgClass != UBX_CLASS_NAV || frame->msgId != UBX_NAV_PVT ) return 0;
+  if( frame->length < UBX_NAV_PVT_LENGTH ) return 0;
+  
+  pvt->iTOW    = ubx_u4( p + 0 );
+  pvt->year    = ubx_u2( p + 4 );
+  pvt->month   = p[6];
+  pvt->day     = p[7];
+  pvt->hour    = p[8];
+  pvt->min     = p[9];
+  pvt->sec     = p[10];
+  pvt->valid   = p[11];
+  pvt->nano    = (int32_t)ubx_u4( p + 16 );
+  pvt->fixType = p[20];
+  pvt->flags   = p[21];
+  pvt->numSV   = p[23];
+  pvt->lon     = (int32_t)ubx_u4( p + 24 );
+  pvt->lat     = (int32_t)ubx_u4( p + 28 );
+  pvt->height  = (int32_t)ubx_u4( p + 32 );
+  pvt->hMSL    = (int32_t)ubx_u4( p + 36 );
+  pvt->hAcc    = ubx_u4( p + 40 );
+  pvt->vAcc    = ubx_u4( p + 44 );
+  pvt->velN    = (int32_t)ubx_u4( p + 48 );
+  pvt->velE    = (int32_t)ubx_u4( p + 52 );
+  pvt->velD    = (int32_t)ubx_u4( p + 56 );
+  pvt->gSpeed  = (int32_t)ubx_u4( p + 60 );
+  pvt->headMot = (int32_t)ubx_u4( p + 64 );
+  pvt->pDOP    = ubx_u2( p + 76 );
+  
+  return 1;
+}
+
+void ubx_pvt_to_fix( const ubx_nav_pvt_t *pvt, gps_fix_t *fix ) {
+  
+  int32_t millis = pvt->nano / 1000000L;
+  
+  fix->valid = 0;
+  
+  // bit 0 of valid is validDate, bit 1 is validTime
+  fix->year = pvt->year;
+  fix->month = pvt->month;
+  fix->day = pvt->day;
+  if( pvt->valid & 0x01 ) fix->valid |= FIX_VALID_DATE;
+  
+  // the fraction is signed, as the seconds are rounded to the nearest
+  fix->time = pvt->hour * 3600UL + pvt->min * 60 + pvt->sec;
+  if( millis < 0 ) {
+    millis += 1000;
+    fix->time = ( fix->time + 86399UL ) % 86400UL;
+  }
+  fix->millis = (uint16_t)millis;
+  if( pvt->valid & 0x02 ) fix->valid |= FIX_VALID_TIME;
+  
+  fix->numSV = pvt->numSV;
+  fix->hdop = pvt->pDOP;
+  
+  // bit 0 of flags is gnssFixOK, bit 1 is diffSoln
+  if( !( pvt->flags & 0x01 ) || pvt->fixType == 0 ) fix->quality = 0;
+  else if( pvt->fixType == 1 ) fix->quality = 6;
+  else if( pvt->flags & 0x02 ) fix->quality = 2;
+  else fix->quality = 1;
+  
+  if( !fix->quality ) return;
+  
+  fix->lat = pvt->lat;
+  fix->lon = pvt->lon;
+  fix->alt = pvt->hMSL;
+  fix->speed = pvt->gSpeed;
+  fix->course = (uint16_t)( pvt->headMot / 1000 );
+  fix->valid |= FIX_VALID_POSITION | FIX_VALID_VELOCITY;
+  if( pvt->fixType == 3 ) fix->valid |= FIX_VALID_ALTITUDE;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+/* 
+ * File:     ubx.h
+ * Author:   agent
+ * Modified: 17 October 2026
+ */
+
+#ifndef UBX_H
+#define	UBX_H
+
+#include <stdint.h>
+#include "gps_fix.h"
+
+/*
+ * UBX is the binary protocol of u-blox receivers. Every frame is:
+ * 
+ * 0xB5 0x62 [class] [id] [length 2 bytes] [payload] [CK_A] [CK_B]
+ * 
+ * Where [class] and [id] together name the message,
+ *       [length] is the payload length, little-endian,
+ *       [CK_A] [CK_B] is an 8-bit Fletcher checksum over every byte from
+ *         [class] to the end of [payload]
+ * 
+ * All multi-byte values in a payload are little-endian.
+ * 
+ * The checksum is calculated as:
+ * 
+ *   let CK_A := 0, CK_B := 0;
+ *   for( byte b from class to end of payload )
+ *     CK_A := CK_A + b
+ *     CK_B := CK_B + CK_A
+ * 
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX Frame Structure"
+ *            "UBX Checksum"
+ */
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+
+// Bytes in a frame besides its payload
+#define UBX_OVERHEAD 8
+
+// Largest payload the parser will accept, enough for an MGA-DBD entry
+#define UBX_MAX_PAYLOAD 176
+
+/* Message classes and ids */
+#define UBX_CLASS_NAV    0x01
+#define UBX_CLASS_ACK    0x05
+#define UBX_CLASS_CFG    0x06
+#define UBX_CLASS_MGA    0x13
+#define UBX_CLASS_NMEA   0xF0
+
+#define UBX_NAV_STATUS   0x03
+#define UBX_NAV_PVT      0x07
+#define UBX_NAV_EOE      0x61
+#define UBX_ACK_NAK      0x00
+#define UBX_ACK_ACK      0x01
+#define UBX_CFG_PRT      0x00
+#define UBX_CFG_MSG      0x01
+#define UBX_CFG_RATE     0x08
+#define UBX_CFG_CFG      0x09
+#define UBX_CFG_RXM      0x11
+#define UBX_CFG_NAV5     0x24
+#define UBX_CFG_PM2      0x3B
+#define UBX_CFG_GNSS     0x3E
+#define UBX_MGA_INI      0x40
+#define UBX_MGA_DBD      0x80
+
+#define UBX_NAV_PVT_LENGTH    92
+#define UBX_NAV_STATUS_LENGTH 16
+
+/*
+ * A frame delivered by the parser, with its checksum already verified.
+ */
+typedef struct {
+  uint8_t  msgClass;
+  uint8_t  msgId;
+  uint16_t length;
+  uint8_t  payload[UBX_MAX_PAYLOAD];
+} ubx_frame_t;
+
+/*
+ * Called by the parser for every frame with a valid checksum.
+ * The frame is only valid until the next byte is pushed.
+ */
+typedef void (*ubx_callback_t)( const ubx_frame_t *frame, void *context );
+
+/*
+ * The state of a parser. Its fields are private to ubx.c.
+ */
+typedef struct {
+  ubx_frame_t    frame;
+  uint8_t        state;
+  uint16_t       index;
+  uint8_t        ckA;
+  uint8_t        ckB;
+  uint16_t       dropped;
+  ubx_callback_t callback;
+  void          *context;
+} ubx_parser_t;
+
+/*
+ * The fields of UBX-NAV-PVT used by the flight software, already in the
+ * integer units the receiver reports them in.
+ * 
+ * Reference: u-blox M8 Receiver Description
+ *            "UBX-NAV-PVT (0x01 0x07)"
+ */
+typedef struct {
+  uint32_t iTOW;      // GPS time of week of the epoch, ms
+  uint16_t year;      // UTC
+  uint8_t  month;
+  uint8_t  day;
+  uint8_t  hour;
+  uint8_t  min;
+  uint8_t  sec;
+  uint8_t  valid;     // validity flags of the date and time
+  int32_t  nano;      // fraction of second, ns
+  uint8_t  fixType;   // 0 none, 2 2D, 3 3D
+  uint8_t  flags;     // bit 0 is gnssFixOK
+  uint8_t  numSV;     // satellites used
+  int32_t  lon;       // 1e-7 deg
+  int32_t  lat;       // 1e-7 deg
+  int32_t  height;    // above ellipsoid, mm
+  int32_t  hMSL;      // above mean sea level, mm
+  uint32_t hAcc;      // mm
+  uint32_t vAcc;      // mm
+  int32_t  velN;      // mm/s
+  int32_t  velE;      // mm/s
+  int32_t  velD;      // mm/s
+  int32_t  gSpeed;    // ground speed, mm/s
+  int32_t  headMot;   // heading of motion, 1e-5 deg
+  uint16_t pDOP;      // 0.01
+} ubx_nav_pvt_t;
+
+/**
+ * Build a UBX frame.
+ * 
+ * Precondition:
+ *   buffer must hold at least length + UBX_OVERHEAD bytes.
+ * 
+ * Postcondition:
+ *   buffer holds the complete frame, checksum included.
+ * 
+ * @param buffer Where the frame will be saved
+ * @param msgClass The message class
+ * @param msgId The message id
+ * @param payload The payload, which may be NULL if length is 0
+ * @param length The payload length
+ * @return The number of bytes in the frame
+ */
+uint16_t ubx_build( uint8_t *buffer, const uint8_t msgClass, const uint8_t msgId,
+                    const uint8_t *payload, const uint16_t length );
+
+/**
+ * Initialize a parser.
+ * 
+ * @param parser The parser to initialize
+ * @param callback The function called with every valid frame
+ * @param context A pointer passed back to the callback
+ */
+void ubx_parser_init( ubx_parser_t *parser, ubx_callback_t callback, void *context );
+
+/**
+ * Push the next byte of the stream into a parser.
+ * 
+ * Precondition:
+ *   parser must be initialized.
+ * 
+ * Postcondition:
+ *   If b completes a valid frame, the callback has been called with it.
+ * 
+ * @param parser The parser
+ * @param b The next byte of the stream
+ */
+void ubx_parser_push( ubx_parser_t *parser, const uint8_t b );
+
+/**
+ * Count the frames a parser has dropped.
+ * 
+ * Frames are dropped when they are too long or their checksum does not
+ * match.
+ * 
+ * @param parser The parser
+ * @return The number of frames dropped since initialization
+ */
+uint16_t ubx_parser_dropped( const ubx_parser_t *parser );
+
+/**
+ * Decode a UBX-NAV-PVT frame.
+ * 
+ * @param frame The frame to decode
+ * @param pvt Where the decoded fields will be saved
+ * @return 1 if frame is a NAV-PVT message, 0 otherwise
+ */
+uint8_t ubx_decode_nav_pvt( const ubx_frame_t *frame, ubx_nav_pvt_t *pvt );
+
+/**
+ * Convert a navigation solution into a fix.
+ * 
+ * Postcondition:
+ *   Every part of fix is replaced, and fix->valid flags the current ones.
+ * 
+ * @param pvt The navigation solution
+ * @param fix Where the fix will be saved
+ */
+void ubx_pvt_to_fix( const ubx_nav_pvt_t *pvt, gps_fix_t *fix );
+
+/**
+ * Read little-endian values out of a payload.
+ */
+uint16_t ubx_u2( const uint8_t *p );
+uint32_t ubx_u4( const uint8_t *p );
+
+#endif	/* UBX_H */